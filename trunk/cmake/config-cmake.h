@@ -36,6 +36,15 @@
 /* Define to 1 if you have the 'strdup' function */
 #cmakedefine HAVE_STRDUP 1
 
+/* Define to 1 if you have the 'pread' function */
+#cmakedefine HAVE_PREAD 1
+
+/* Define to 1 if you have the 'pwrite' function */
+#cmakedefine HAVE_PWRITE 1
+
+/* Define to 1 if you have the 'mmap' function */
+#cmakedefine HAVE_MMAP 1
+
 
 /* Relative path from bindir to datadir */
 #define BIN2DATADIR "@BIN2DATADIR@"
@@ -32,6 +32,7 @@ void NextBusSlot::board_bput(Uint32 addr, Uint8 val)  {bus_error(addr, "bput");}
 
 void NextBusSlot::reset(void) {}
 void NextBusSlot::pause(bool pause) {}
+void NextBusSlot::snapshot(bool bSave) {}
 
 NextBusBoard::NextBusBoard(int slot) : NextBusSlot(slot) {}
 
@@ -189,4 +190,9 @@ extern "C" {
         for(int slot = 0; slot < 16; slot++)
             nextbus[slot]->pause(pause);
     }
+    
+    void NextBus_MemorySnapShot_Capture(bool bSave) {
+        for(int slot = 0; slot < 16; slot++)
+            nextbus[slot]->snapshot(bSave);
+    }
 }
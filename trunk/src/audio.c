@@ -119,6 +119,12 @@ void Audio_Output_Init(void)
     SDL_AudioSpec request;    /* We fill in the desired SDL audio options here */
     SDL_AudioSpec granted;
     
+    /* No audio device in headless mode */
+    if (bHeadless) {
+        bSoundOutputWorking = false;
+        return;
+    }
+    
     /* Init the SDL's audio subsystem: */
     if (SDL_WasInit(SDL_INIT_AUDIO) == 0) {
         if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
@@ -162,6 +168,12 @@ void Audio_Input_Init(void) {
     SDL_AudioSpec request;    /* We fill in the desired SDL audio options here */
     SDL_AudioSpec granted;
     
+    /* No audio device in headless mode, record silence */
+    if (bHeadless) {
+        bSoundInputWorking = false;
+        return;
+    }
+    
     /* Init the SDL's audio subsystem: */
     if (SDL_WasInit(SDL_INIT_AUDIO) == 0) {
         if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
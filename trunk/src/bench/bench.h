@@ -0,0 +1,30 @@
+/*
+  Previous - bench.h
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Common helpers of the benchmark programs in this directory. They are
+  only built if ENABLE_BENCHMARKS is set in CMake.
+*/
+
+#ifndef PREV_BENCH_H
+#define PREV_BENCH_H
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Host time in seconds, only differences are meaningful */
+static inline double bench_time(void) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    return (double)now / SDL_GetPerformanceFrequency();
+}
+
+/* Optional first argument: seconds to run each measurement */
+static inline double bench_duration(int argc, char *argv[]) {
+    double sec = argc > 1 ? atof(argv[1]) : 0.0;
+    return sec > 0.0 ? sec : 1.0;
+}
+
+#endif /* PREV_BENCH_H */
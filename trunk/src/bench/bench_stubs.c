@@ -0,0 +1,74 @@
+/*
+  Previous - bench_stubs.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Minimal replacements for the emulator state and functions that the
+  modules linked into the benchmark programs refer to.
+*/
+
+#include <stdarg.h>
+
+#include "main.h"
+#include "configuration.h"
+#include "log.h"
+#include "memorySnapShot.h"
+#include "memory.h"
+#include "newcpu.h"
+#include "dsp.h"
+#include "statusbar.h"
+#include "profile.h"
+
+CNF_PARAMS       ConfigureParams;
+Sint64           nCyclesMainCounter;
+struct regstruct regs;
+mem_get_func     bank_lget[65536];
+
+void _Log_Printf(LOGTYPE nType, const char *psFormat, ...) {
+    va_list args;
+
+    if (nType > LOG_WARN) {
+        return;
+    }
+    va_start(args, psFormat);
+    vfprintf(stderr, psFormat, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+void MemorySnapShot_Store(void *pData, int Size) {
+}
+
+/* see host.c */
+void nd_display_blank(int num);
+void nd_video_blank(int num);
+
+void nd_display_blank(int num) {
+}
+
+void nd_video_blank(int num) {
+}
+
+/* see dsp.c */
+void DSP_HandleTXD(int set) {
+}
+
+void DSP_SsiTransmit_SC1(void) {
+}
+
+void DSP_SsiTransmit_SC2(Uint32 frame) {
+}
+
+void DSP_DebugException(void) {
+}
+
+FILE  *TraceFile;
+Uint64 LogTraceFlags;
+
+void Statusbar_SetDspLed(bool state) {
+}
+
+bool Profile_DspAddressData(Uint16 addr, Uint32 *count, Uint32 *cycles) {
+    return false;
+}
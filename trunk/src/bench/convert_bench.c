@@ -0,0 +1,107 @@
+/*
+  Previous - convert_bench.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Frames per second of the framebuffer conversion kernels in
+  screen_convert.c for a full 1120x832 BW, color and NeXTdimension frame.
+  Every kernel set the host supports is measured with a texture format
+  that has 8 bit channels and with one that needs lookup tables. The
+  output of each kernel is compared with the scalar kernels.
+
+  Usage: bench_convert [seconds]
+*/
+
+const char ConvertBench_fileid[] = "Previous convert_bench.c : " __DATE__ " " __TIME__;
+
+#include "main.h"
+#include "screen_convert.h"
+#include "bench.h"
+
+#define BENCH_WIDTH  1120
+#define BENCH_HEIGHT 832
+#define BENCH_PIXELS (BENCH_WIDTH * BENCH_HEIGHT)
+
+enum {
+    BENCH_BW,
+    BENCH_COLOR,
+    BENCH_DIMENSION,
+    BENCH_FORMATS
+};
+
+static Uint8  srcBW[BENCH_PIXELS / 4];
+static Uint8  srcColor[BENCH_PIXELS * 2];
+static Uint32 srcDimension[BENCH_PIXELS];
+static Uint32 dst[BENCH_PIXELS];
+static Uint32 ref[BENCH_FORMATS][BENCH_PIXELS];
+
+static convert_format_t ndFormat;
+
+static void convert(int type) {
+    switch (type) {
+        case BENCH_BW:        Convert_BW(dst, srcBW, BENCH_PIXELS / 4); break;
+        case BENCH_COLOR:     Convert_Color(dst, srcColor, BENCH_PIXELS); break;
+        case BENCH_DIMENSION: Convert_Dimension(&ndFormat, dst, srcDimension, BENCH_PIXELS); break;
+    }
+}
+
+static double frames_per_sec(int type, double duration) {
+    double start = bench_time();
+    double now;
+    int frames = 0;
+
+    do {
+        convert(type);
+        frames++;
+        now = bench_time();
+    } while (now - start < duration);
+    return frames / (now - start);
+}
+
+static void run(const char *format_name, Uint32 format, double duration) {
+    static const char *kernels[] = { "scalar", "SSE2", "AVX2", "NEON" };
+    double fps[BENCH_FORMATS];
+    int i, type;
+
+    Convert_Init(format);
+    Convert_SetFormat(&ndFormat, format);
+
+    for (i = 0; i < (int)(sizeof(kernels) / sizeof(kernels[0])); i++) {
+        if (!Convert_UseKernels(kernels[i])) {
+            continue;
+        }
+        for (type = 0; type < BENCH_FORMATS; type++) {
+            convert(type);
+            if (i == 0) {
+                memcpy(ref[type], dst, sizeof(dst));
+            } else if (memcmp(ref[type], dst, sizeof(dst))) {
+                printf("%s %s: output differs from scalar kernel\n", format_name, kernels[i]);
+            }
+            fps[type] = frames_per_sec(type, duration);
+        }
+        printf("%-9s %-7s BW %8.1f   Color %8.1f   Dimension %8.1f frames/s\n",
+               format_name, kernels[i], fps[BENCH_BW], fps[BENCH_COLOR], fps[BENCH_DIMENSION]);
+    }
+    Convert_FreeFormat(&ndFormat);
+}
+
+int main(int argc, char *argv[]) {
+    double duration = bench_duration(argc, argv);
+    int i;
+
+    srand(1);
+    for (i = 0; i < (int)sizeof(srcBW); i++) {
+        srcBW[i] = rand();
+    }
+    for (i = 0; i < (int)sizeof(srcColor); i++) {
+        srcColor[i] = rand();
+    }
+    for (i = 0; i < BENCH_PIXELS; i++) {
+        srcDimension[i] = ((Uint32)rand() << 16) ^ rand();
+    }
+
+    run("ARGB8888", SDL_PIXELFORMAT_ARGB8888, duration);
+    run("RGB565",   SDL_PIXELFORMAT_RGB565,   duration);
+    return 0;
+}
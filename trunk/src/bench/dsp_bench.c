@@ -0,0 +1,198 @@
+/*
+  Previous - dsp_bench.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Instructions per second of the DSP56001 core for two fixed programs in
+  internal P memory: a 64 tap FIR filter and a 64 point complex FFT (the
+  radix 2 FFT from the Motorola application notes). Each run restores the
+  input data and starts the program at p:0000, it ends when the PC reaches
+  the end of the program. The results of the first run are checked.
+
+  Usage: bench_dsp [seconds]
+*/
+
+const char DSPBench_fileid[] = "Previous dsp_bench.c : " __DATE__ " " __TIME__;
+
+#include <math.h>
+
+#include "main.h"
+#include "dsp_core.h"
+#include "dsp_cpu.h"
+#include "bench.h"
+
+#define BENCH_TAPS   64
+#define BENCH_POINTS 64
+#define BENCH_TONE   5
+#define BENCH_COEF   0x40  /* FFT twiddle factors in x:/y: */
+
+/* y:sum(x:(r0)*y:(r4)) into A */
+static const Uint32 fir_program[] = {
+    0x300000,   /* move #$00,r0                                  */
+    0x340000,   /* move #$00,r4                                  */
+    0xf09813,   /* clr a         x:(r0)+,x0     y:(r4)+,y0       */
+    0x0600a0 | ((BENCH_TAPS - 1) << 8),
+                /* rep #BENCH_TAPS-1                             */
+    0xf098d2,   /* mac x0,y0,a   x:(r0)+,x0     y:(r4)+,y0       */
+    0x2000d3    /* macr x0,y0,a                                  */
+};
+
+/* In place, real parts in x:, imaginary parts in y:, output in bit
+ * reversed order. -cos in x:BENCH_COEF, -sin in y:BENCH_COEF. */
+static const Uint32 fft_program[] = {
+    0x382000,   /* move #$20,n0                                  */
+    0x3a0100,   /* move #$01,n2                                  */
+    0x3e1000,   /* move #$10,n6                                  */
+    0x0500a6,   /* movec #$00,m6                                 */
+    0x060680,   /* do #6,p:$0020                                 */
+    0x000020,
+    0x300000,   /* move #$00,r0                                  */
+    0x221400,   /* move r0,r4                                    */
+    0x044811,   /* lua (r0)+n0,r1                                */
+    0x364000,   /* move #BENCH_COEF,r6                           */
+    0x045115,   /* lua (r1)-,r5                                  */
+    0x231900,   /* move n0,n1                                    */
+    0x231c00,   /* move n0,n4                                    */
+    0x231d00,   /* move n0,n5                                    */
+    0x06da00,   /* do n2,p:$001c                                 */
+    0x00001c,
+    0xc4c100,   /* move x:(r1),x1  y:(r6),y0                     */
+    0xcb8500,   /* move x:(r5),a   y:(r0),b                      */
+    0x44ce00,   /* move x:(r6)+n6,x0                             */
+    0x06d800,   /* do n0,p:$001a                                 */
+    0x00001a,
+    0x4fd9ea,   /* mac x1,y0,b     y:(r1)+,y1                    */
+    0xca1dcf,   /* macr -x0,y1,b   a,x:(r5)+      y:(r0),a       */
+    0x8f8016,   /* subl b,a        x:(r0),b       b,y:(r4)       */
+    0x8ab8ae,   /* mac -x1,x0,b    x:(r0)+,a      a,y:(r5)       */
+    0x45e1bf,   /* macr -y1,y0,b   x:(r1),x1                     */
+    0xcf1c16,   /* subl b,a        b,x:(r4)+      y:(r0),b       */
+    0xd92d00,   /* move a,x:(r5)+n5  y:(r1)+n1,y1                */
+    0xd58800,   /* move x:(r0)+n0,x1 y:(r4)+n4,y1                */
+    0x230d00,   /* move n0,b1                                    */
+    0x234c2b,   /* lsr b  n2,a1                                  */
+    0x21b833,   /* lsl a  b1,n0                                  */
+    0x219a00    /* move a1,n2                                    */
+};
+
+typedef struct {
+    const char   *name;
+    const Uint32 *program;
+    int           length;
+    Uint32        data[2][0x100];  /* initial x: and y: internal RAM */
+} bench_program_t;
+
+static bench_program_t fir = { "FIR", fir_program, sizeof(fir_program) / sizeof(Uint32) };
+static bench_program_t fft = { "FFT", fft_program, sizeof(fft_program) / sizeof(Uint32) };
+
+static void host_interrupt(int set) {
+}
+
+static Uint32 to_fixed(double v) {
+    long fixed = lrint(v * 8388608.0);
+
+    return (Uint32)fixed & 0xffffff;
+}
+
+static double from_fixed(Uint32 v) {
+    return (Sint32)(v << 8) / 2147483648.0;
+}
+
+/* Run the program once, returns the number of instructions */
+static int run(bench_program_t *p, Uint64 *cycles) {
+    int n = 0;
+
+    memcpy(dsp_core.ramint[DSP_SPACE_X], p->data[DSP_SPACE_X], sizeof(p->data[0]));
+    memcpy(dsp_core.ramint[DSP_SPACE_Y], p->data[DSP_SPACE_Y], sizeof(p->data[0]));
+    dsp_core.pc = 0;
+    do {
+        dsp56k_execute_instruction();
+        *cycles += dsp_core.instr_cycle;
+        n++;
+    } while (dsp_core.pc != p->length);
+    return n;
+}
+
+static void load(bench_program_t *p) {
+    dsp_core_reset();
+    memcpy(dsp_core.ramint[DSP_SPACE_P], p->program, p->length * sizeof(Uint32));
+    dsp_core.running = 1;
+}
+
+static bool check_fir(void) {
+    double sum = 0.0, a;
+    int i;
+
+    for (i = 0; i < BENCH_TAPS; i++) {
+        sum += from_fixed(fir.data[DSP_SPACE_X][i]) * from_fixed(fir.data[DSP_SPACE_Y][i]);
+    }
+    a = from_fixed(dsp_core.registers[DSP_REG_A1]);
+    return fabs(a - sum) < 1e-6;
+}
+
+static bool check_fft(void) {
+    double re, im, expect;
+    int i, bin = 0;
+
+    /* Bin BENCH_TONE is at its bit reversed index */
+    for (i = 0; i < 6; i++) {
+        bin |= ((BENCH_TONE >> i) & 1) << (5 - i);
+    }
+    for (i = 0; i < BENCH_POINTS; i++) {
+        re = from_fixed(dsp_core.ramint[DSP_SPACE_X][i]);
+        im = from_fixed(dsp_core.ramint[DSP_SPACE_Y][i]);
+        expect = i == bin ? BENCH_POINTS * 0.01 : 0.0;
+        if (fabs(re - expect) > 1e-4 || fabs(im) > 1e-4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void measure(bench_program_t *p, bool (*check)(void), double duration) {
+    double start, now;
+    Uint64 instructions = 0;
+    Uint64 cycles = 0;
+
+    load(p);
+    run(p, &cycles);
+    if (!check()) {
+        printf("%s: wrong result\n", p->name);
+    }
+
+    cycles = 0;
+    start = bench_time();
+    do {
+        instructions += run(p, &cycles);
+        now = bench_time();
+    } while (now - start < duration);
+
+    /* The DSP56001 in the NeXT runs at 25 MHz */
+    printf("%s: %7.2f M instructions/s  %5.2f x real time\n", p->name,
+           instructions / (now - start) / 1e6, cycles / (now - start) / 25e6);
+}
+
+int main(int argc, char *argv[]) {
+    double duration = bench_duration(argc, argv);
+    int i;
+
+    srand(1);
+    for (i = 0; i < BENCH_TAPS; i++) {
+        fir.data[DSP_SPACE_X][i] = to_fixed((rand() / (double)RAND_MAX - 0.5) * 0.2);
+        fir.data[DSP_SPACE_Y][i] = to_fixed((rand() / (double)RAND_MAX - 0.5) * 0.2);
+    }
+    for (i = 0; i < BENCH_POINTS; i++) {
+        fft.data[DSP_SPACE_X][i] = to_fixed(0.01 * cos(2 * M_PI * BENCH_TONE * i / BENCH_POINTS));
+        fft.data[DSP_SPACE_Y][i] = to_fixed(0.01 * sin(2 * M_PI * BENCH_TONE * i / BENCH_POINTS));
+    }
+    for (i = 0; i < BENCH_POINTS / 2; i++) {
+        fft.data[DSP_SPACE_X][BENCH_COEF + i] = to_fixed(-cos(2 * M_PI * i / BENCH_POINTS) * 0.999999);
+        fft.data[DSP_SPACE_Y][BENCH_COEF + i] = to_fixed(-sin(2 * M_PI * i / BENCH_POINTS) * 0.999999);
+    }
+
+    dsp_core_init(host_interrupt);
+    measure(&fir, check_fir, duration);
+    measure(&fft, check_fft, duration);
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+  Previous - host_bench.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Calls per second of host_time_us() on the thread that owns the clock
+  (the m68k thread in the emulator) and on other threads (like the i860
+  thread), each alone and all at the same time. The last run keeps
+  switching the owner between real-time and cycle-time, so the other
+  threads also retry on the sequence lock.
+
+  Usage: bench_host [seconds] [threads]
+*/
+
+const char HostBench_fileid[] = "Previous host_bench.c : " __DATE__ " " __TIME__;
+
+#include "main.h"
+#include "configuration.h"
+#include "host.h"
+#include "memory.h"
+#include "newcpu.h"
+#include "bench.h"
+
+#define BENCH_MAX_THREADS 16
+
+typedef struct {
+    Uint64 calls;
+    double seconds;
+} reader_t;
+
+static atomic_int bench_stop;
+static volatile Uint64 bench_sink;
+
+static int reader_thread(void *data) {
+    reader_t *r = data;
+    double start = bench_time();
+    Uint64 calls = 0;
+    Uint64 sum = 0;
+
+    while (!host_atomic_get(&bench_stop)) {
+        sum += host_time_us();
+        calls++;
+    }
+    bench_sink += sum;
+    r->calls = calls;
+    r->seconds = bench_time() - start;
+    return 0;
+}
+
+/* Call host_time_us() on the owner thread, optionally switching the
+ * clock between real-time and cycle-time every 1024 calls */
+static double run_owner(double duration, bool switching) {
+    double start = bench_time();
+    double end = start + duration;
+    Uint64 calls = 0;
+    Uint64 sum = 0;
+
+    do {
+        for (int i = 0; i < 1024; i++) {
+            sum += host_time_us();
+        }
+        calls += 1024;
+        if (switching) {
+            regs.s = !regs.s;
+        }
+    } while (bench_time() < end);
+    bench_sink += sum;
+    return calls / (bench_time() - start);
+}
+
+static void run(const char *name, double duration, int threads, bool owner, bool switching) {
+    thread_t *thread[BENCH_MAX_THREADS];
+    reader_t reader[BENCH_MAX_THREADS];
+    double owner_rate = 0.0;
+    double reader_rate = 0.0;
+    int i;
+
+    ConfigureParams.System.bRealtime = switching;
+    regs.s = 1;
+    host_reset();
+
+    host_atomic_set(&bench_stop, 0);
+    for (i = 0; i < threads; i++) {
+        thread[i] = host_thread_create(reader_thread, "[Bench] reader", &reader[i]);
+    }
+    if (owner) {
+        owner_rate = run_owner(duration, switching);
+    } else {
+        host_sleep_sec(duration);
+    }
+    host_atomic_set(&bench_stop, 1);
+    for (i = 0; i < threads; i++) {
+        host_thread_wait(thread[i]);
+        reader_rate += reader[i].calls / reader[i].seconds;
+    }
+
+    printf("%-28s owner %8.2f Mcalls/s   %d other thread%s %8.2f Mcalls/s\n", name,
+           owner_rate / 1e6, threads, threads == 1 ? " " : "s", reader_rate / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+    double duration = bench_duration(argc, argv);
+    int threads = argc > 2 ? atoi(argv[2]) : 1;
+
+    if (threads < 1 || threads > BENCH_MAX_THREADS) {
+        threads = 1;
+    }
+    ConfigureParams.System.nCpuFreq = 25;
+
+    run("owner only",                duration, 0,       true,  false);
+    run("other threads only",        duration, threads, false, false);
+    run("owner and other threads",   duration, threads, true,  false);
+    run("owner switching realtime",  duration, threads, true,  true);
+    return 0;
+}
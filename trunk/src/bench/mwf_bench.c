@@ -0,0 +1,123 @@
+/*
+  Previous - mwf_bench.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Memory write functions per second of the nibble lookup tables in
+  cpu/memory_mwf.c compared with the former loop over every 2 bit pixel.
+  Both are run on the same random data for every function and access size
+  and their results are compared.
+
+  Usage: bench_mwf [seconds]
+*/
+
+const char MWFBench_fileid[] = "Previous mwf_bench.c : " __DATE__ " " __TIME__;
+
+#include "config.h"
+#include "sysdeps.h"
+#include "memory_mwf.h"
+#include "bench.h"
+
+#define BENCH_VALUES 4096
+
+static uae_u32 oldval[BENCH_VALUES];
+static uae_u32 newval[BENCH_VALUES];
+
+/* Former implementation, one table lookup per pixel */
+static uae_u32 memory_write_func_pixel(uae_u32 old, uae_u32 new, int function, int size)
+{
+	int a,b,i;
+	uae_u32 v=0;
+	
+	for (i=0; i<(size*4); i++) {
+		a=old>>(i*2)&3;
+		b=new>>(i*2)&3;
+		v|=mwf_pixel[function][a][b]<<(i*2);
+	}
+	return v;
+}
+
+/* Constant sizes like the callers in memory.c */
+static uae_u32 run_pixel(int function, int size)
+{
+	uae_u32 sum = 0;
+	int i;
+	
+	for (i = 0; i < BENCH_VALUES; i++) {
+		switch (size) {
+			case 1: sum += memory_write_func_pixel(oldval[i], newval[i], function, 1); break;
+			case 2: sum += memory_write_func_pixel(oldval[i], newval[i], function, 2); break;
+			case 4: sum += memory_write_func_pixel(oldval[i], newval[i], function, 4); break;
+		}
+	}
+	return sum;
+}
+
+static uae_u32 run_nibble(int function, int size)
+{
+	uae_u32 sum = 0;
+	int i;
+	
+	for (i = 0; i < BENCH_VALUES; i++) {
+		switch (size) {
+			case 1: sum += memory_write_func(oldval[i], newval[i], function, 1); break;
+			case 2: sum += memory_write_func(oldval[i], newval[i], function, 2); break;
+			case 4: sum += memory_write_func(oldval[i], newval[i], function, 4); break;
+		}
+	}
+	return sum;
+}
+
+static volatile uae_u32 sink;
+
+static double calls_per_sec(uae_u32 (*run)(int, int), int size, double duration)
+{
+	double start = bench_time();
+	double now;
+	long rounds = 0;
+	int function;
+	
+	do {
+		for (function = 0; function < 4; function++)
+			sink += run(function, size);
+		rounds++;
+		now = bench_time();
+	} while (now - start < duration);
+	return rounds * 4.0 * BENCH_VALUES / (now - start);
+}
+
+int main(int argc, char *argv[])
+{
+	static const int sizes[] = { 1, 2, 4 };
+	double duration = bench_duration(argc, argv);
+	double pixel, nibble;
+	uae_u32 mask;
+	int i, s, function;
+	
+	memory_write_func_init();
+	
+	srand(1);
+	for (i = 0; i < BENCH_VALUES; i++) {
+		oldval[i] = ((uae_u32)rand() << 16) ^ rand();
+		newval[i] = ((uae_u32)rand() << 16) ^ rand();
+	}
+	
+	for (s = 0; s < 3; s++) {
+		mask = sizes[s] == 4 ? 0xFFFFFFFF : (1u << (sizes[s] * 8)) - 1;
+		for (function = 0; function < 4; function++) {
+			for (i = 0; i < BENCH_VALUES; i++) {
+				if (memory_write_func(oldval[i] & mask, newval[i] & mask, function, sizes[s]) !=
+				    memory_write_func_pixel(oldval[i] & mask, newval[i] & mask, function, sizes[s])) {
+					printf("size %d function %d: results differ\n", sizes[s], function);
+					break;
+				}
+			}
+		}
+		pixel  = calls_per_sec(run_pixel, sizes[s], duration);
+		nibble = calls_per_sec(run_nibble, sizes[s], duration);
+		printf("size %d: pixel loop %7.1f M/s   nibble table %7.1f M/s   %.2fx\n",
+		       sizes[s], pixel / 1e6, nibble / 1e6, nibble / pixel);
+	}
+	return 0;
+}
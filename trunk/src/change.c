@@ -111,7 +111,8 @@ bool Change_DoNeedReset(CNF_PARAMS *current, CNF_PARAMS *changed)
 	
 	/* Did we change DSP type or memory? */
 	if ((current->System.nDSPType != changed->System.nDSPType) ||
-		(current->System.bDSPMemoryExpansion != changed->System.bDSPMemoryExpansion)) {
+		(current->System.bDSPMemoryExpansion != changed->System.bDSPMemoryExpansion) ||
+		(current->System.bDSPThread != changed->System.bDSPThread)) {
 		printf("dsp type reset\n");
 		return true;
 	}
@@ -181,7 +182,8 @@ bool Change_DoNeedReset(CNF_PARAMS *current, CNF_PARAMS *changed)
         if (current->SCSI.target[i].nDeviceType != changed->SCSI.target[i].nDeviceType ||
             (current->SCSI.target[i].nDeviceType==DEVTYPE_HARDDISK &&
              (current->SCSI.target[i].bWriteProtected != changed->SCSI.target[i].bWriteProtected ||
-              strcmp(current->SCSI.target[i].szImageName, changed->SCSI.target[i].szImageName)))) {
+              strcmp(current->SCSI.target[i].szImageName, changed->SCSI.target[i].szImageName) ||
+              strcmp(current->SCSI.target[i].szOverlayName, changed->SCSI.target[i].szOverlayName)))) {
                  printf("scsi disk reset\n");
                  return true;
              }
@@ -190,6 +192,10 @@ bool Change_DoNeedReset(CNF_PARAMS *current, CNF_PARAMS *changed)
         printf("scsi disk reset\n");
         return true;
     }
+    if(current->System.bMapDiskImages != changed->System.bMapDiskImages) {
+        printf("disk image mapping reset\n");
+        return true;
+    }
     
     /* Did we change MO drive? */
     for (i = 0; i < MO_MAX_DRIVES; i++) {
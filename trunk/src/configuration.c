@@ -22,6 +22,7 @@ const char Configuration_fileid[] = "Hatari configuration.c : " __DATE__ " " __T
 #include "paths.h"
 #include "screen.h"
 #include "video.h"
+#include "memorySnapShot.h"
 
 CNF_PARAMS ConfigureParams;                 /* List of configuration for the emulator */
 char sConfigFileName[FILENAME_MAX];         /* Stores the name of the configuration file */
@@ -138,6 +139,8 @@ static const struct Config_Tag configs_Memory[] =
 	{ "nMemoryBankSize2", Int_Tag, &ConfigureParams.Memory.nMemoryBankSize[2] },
 	{ "nMemoryBankSize3", Int_Tag, &ConfigureParams.Memory.nMemoryBankSize[3] },
     { "nMemorySpeed", Int_Tag, &ConfigureParams.Memory.nMemorySpeed },
+    { "bAutoSave", Bool_Tag, &ConfigureParams.Memory.bAutoSave },
+    { "szMemoryCaptureFileName", String_Tag, ConfigureParams.Memory.szMemoryCaptureFileName },
 	{ NULL , Error_Tag, NULL }
 };
 
@@ -162,36 +165,43 @@ static const struct Config_Tag configs_SCSI[] =
     { "nDeviceType0", Int_Tag, &ConfigureParams.SCSI.target[0].nDeviceType },
     { "bDiskInserted0", Bool_Tag, &ConfigureParams.SCSI.target[0].bDiskInserted },
     { "bWriteProtected0", Bool_Tag, &ConfigureParams.SCSI.target[0].bWriteProtected },
+    { "szOverlayName0", String_Tag, ConfigureParams.SCSI.target[0].szOverlayName },
     
     { "szImageName1", String_Tag, ConfigureParams.SCSI.target[1].szImageName },
     { "nDeviceType1", Int_Tag, &ConfigureParams.SCSI.target[1].nDeviceType },
     { "bDiskInserted1", Bool_Tag, &ConfigureParams.SCSI.target[1].bDiskInserted },
     { "bWriteProtected1", Bool_Tag, &ConfigureParams.SCSI.target[1].bWriteProtected },
+    { "szOverlayName1", String_Tag, ConfigureParams.SCSI.target[1].szOverlayName },
 
     { "szImageName2", String_Tag, ConfigureParams.SCSI.target[2].szImageName },
     { "nDeviceType2", Int_Tag, &ConfigureParams.SCSI.target[2].nDeviceType },
     { "bDiskInserted2", Bool_Tag, &ConfigureParams.SCSI.target[2].bDiskInserted },
     { "bWriteProtected2", Bool_Tag, &ConfigureParams.SCSI.target[2].bWriteProtected },
+    { "szOverlayName2", String_Tag, ConfigureParams.SCSI.target[2].szOverlayName },
 
     { "szImageName3", String_Tag, ConfigureParams.SCSI.target[3].szImageName },
     { "nDeviceType3", Int_Tag, &ConfigureParams.SCSI.target[3].nDeviceType },
     { "bDiskInserted3", Bool_Tag, &ConfigureParams.SCSI.target[3].bDiskInserted },
     { "bWriteProtected3", Bool_Tag, &ConfigureParams.SCSI.target[3].bWriteProtected },
+    { "szOverlayName3", String_Tag, ConfigureParams.SCSI.target[3].szOverlayName },
 
     { "szImageName4", String_Tag, ConfigureParams.SCSI.target[4].szImageName },
     { "nDeviceType4", Int_Tag, &ConfigureParams.SCSI.target[4].nDeviceType },
     { "bDiskInserted4", Bool_Tag, &ConfigureParams.SCSI.target[4].bDiskInserted },
     { "bWriteProtected4", Bool_Tag, &ConfigureParams.SCSI.target[4].bWriteProtected },
+    { "szOverlayName4", String_Tag, ConfigureParams.SCSI.target[4].szOverlayName },
 
     { "szImageName5", String_Tag, ConfigureParams.SCSI.target[5].szImageName },
     { "nDeviceType5", Int_Tag, &ConfigureParams.SCSI.target[5].nDeviceType },
     { "bDiskInserted5", Bool_Tag, &ConfigureParams.SCSI.target[5].bDiskInserted },
     { "bWriteProtected5", Bool_Tag, &ConfigureParams.SCSI.target[5].bWriteProtected },
+    { "szOverlayName5", String_Tag, ConfigureParams.SCSI.target[5].szOverlayName },
 
     { "szImageName6", String_Tag, ConfigureParams.SCSI.target[6].szImageName },
     { "nDeviceType6", Int_Tag, &ConfigureParams.SCSI.target[6].nDeviceType },
     { "bDiskInserted6", Bool_Tag, &ConfigureParams.SCSI.target[6].bDiskInserted },
     { "bWriteProtected6", Bool_Tag, &ConfigureParams.SCSI.target[6].bWriteProtected },
+    { "szOverlayName6", String_Tag, ConfigureParams.SCSI.target[6].szOverlayName },
 
     { "nWriteProtection", Int_Tag, &ConfigureParams.SCSI.nWriteProtection },
     
@@ -283,12 +293,18 @@ static const struct Config_Tag configs_System[] =
 	{ "nCpuFreq", Int_Tag, &ConfigureParams.System.nCpuFreq },
 	{ "bCompatibleCpu", Bool_Tag, &ConfigureParams.System.bCompatibleCpu },
 	{ "bRealtime", Bool_Tag, &ConfigureParams.System.bRealtime },
+	{ "bIdleSkip", Bool_Tag, &ConfigureParams.System.bIdleSkip },
+	{ "szIdleLoopPCs", String_Tag, ConfigureParams.System.szIdleLoopPCs },
 	{ "nDSPType", Int_Tag, &ConfigureParams.System.nDSPType },
 	{ "bDSPMemoryExpansion", Bool_Tag, &ConfigureParams.System.bDSPMemoryExpansion },
+	{ "bDSPThread", Bool_Tag, &ConfigureParams.System.bDSPThread },
+	{ "nDSPMaxSkew", Int_Tag, &ConfigureParams.System.nDSPMaxSkew },
 	{ "bRealTimeClock", Bool_Tag, &ConfigureParams.System.bRealTimeClock },
     { "n_FPUType", Int_Tag, &ConfigureParams.System.n_FPUType },
     { "bCompatibleFPU", Bool_Tag, &ConfigureParams.System.bCompatibleFPU },
     { "bMMU", Bool_Tag, &ConfigureParams.System.bMMU },
+    { "bMapDiskImages", Bool_Tag, &ConfigureParams.System.bMapDiskImages },
+    { "bAsyncDiskIO", Bool_Tag, &ConfigureParams.System.bAsyncDiskIO },
     { NULL , Error_Tag, NULL }
 };
 
@@ -296,6 +312,8 @@ static const struct Config_Tag configs_System[] =
 static const struct Config_Tag configs_Dimension[] =
 {
     { "bI860Thread",       Bool_Tag, &ConfigureParams.Dimension.bI860Thread },
+    { "bI860HostFPU",      Bool_Tag, &ConfigureParams.Dimension.bI860HostFPU },
+    { "bI860HostFPUCheck", Bool_Tag, &ConfigureParams.Dimension.bI860HostFPUCheck },
     { "bMainDisplay",      Bool_Tag, &ConfigureParams.Dimension.bMainDisplay },
     { "nMainDisplay",      Int_Tag,  &ConfigureParams.Dimension.nMainDisplay },
 
@@ -371,6 +389,7 @@ void Configuration_SetDefault(void)
         ConfigureParams.SCSI.target[i].nDeviceType = DEVTYPE_NONE;
         ConfigureParams.SCSI.target[i].bDiskInserted = false;
         ConfigureParams.SCSI.target[i].bWriteProtected = false;
+        ConfigureParams.SCSI.target[i].szOverlayName[0] = '\0';
     }
     ConfigureParams.SCSI.nWriteProtection = WRITEPROT_OFF;
     
@@ -430,6 +449,9 @@ void Configuration_SetDefault(void)
 	memset(ConfigureParams.Memory.nMemoryBankSize, 16, 
            sizeof(ConfigureParams.Memory.nMemoryBankSize)); /* 64 MiB */
     ConfigureParams.Memory.nMemorySpeed = MEMORY_100NS;
+    ConfigureParams.Memory.bAutoSave = false;
+    sprintf(ConfigureParams.Memory.szMemoryCaptureFileName, "%s%cprevious.sav",
+            psHomeDir, PATHSEP);
 
 	/* Set defaults for Printer */
 	ConfigureParams.Printer.bPrinterConnected = false;
@@ -473,15 +495,23 @@ void Configuration_SetDefault(void)
 	ConfigureParams.System.nCpuFreq = 25;
 	ConfigureParams.System.bCompatibleCpu = true;
 	ConfigureParams.System.bRealtime = false;
+	ConfigureParams.System.bIdleSkip = true;
+	strcpy(ConfigureParams.System.szIdleLoopPCs, "");
 	ConfigureParams.System.nDSPType = DSP_TYPE_EMU;
 	ConfigureParams.System.bDSPMemoryExpansion = false;
+	ConfigureParams.System.bDSPThread = host_num_cpus() != 1;
+	ConfigureParams.System.nDSPMaxSkew = 2048;
 	ConfigureParams.System.bRealTimeClock = true;
     ConfigureParams.System.n_FPUType = FPU_68882;
     ConfigureParams.System.bCompatibleFPU = true;
     ConfigureParams.System.bMMU = true;
+    ConfigureParams.System.bMapDiskImages = false;
+    ConfigureParams.System.bAsyncDiskIO = host_num_cpus() != 1;
     
     /* Set defaults for Dimension */
     ConfigureParams.Dimension.bI860Thread  = host_num_cpus() != 1;
+    ConfigureParams.Dimension.bI860HostFPU = true;
+    ConfigureParams.Dimension.bI860HostFPUCheck = false;
     ConfigureParams.Dimension.bMainDisplay = false;
     ConfigureParams.Dimension.nMainDisplay = 0;
     for (i = 0; i < ND_MAX_BOARDS; i++) {
@@ -893,3 +923,23 @@ void Configuration_Save(void)
     Configuration_SaveSection(sConfigFileName, configs_Dimension, "[Dimension]");
 }
 
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/restore the machine part of the configuration to/from snapshot
+ * file. Host side settings (screen, keyboard, sound, etc.) are kept.
+ */
+void Configuration_MemorySnapShot_Capture(bool bSave)
+{
+	MemorySnapShot_Store(&ConfigureParams.System, sizeof(ConfigureParams.System));
+	MemorySnapShot_Store(ConfigureParams.Memory.nMemoryBankSize, sizeof(ConfigureParams.Memory.nMemoryBankSize));
+	MemorySnapShot_Store(&ConfigureParams.Memory.nMemorySpeed, sizeof(ConfigureParams.Memory.nMemorySpeed));
+	MemorySnapShot_Store(&ConfigureParams.Rom, sizeof(ConfigureParams.Rom));
+	MemorySnapShot_Store(&ConfigureParams.Boot, sizeof(ConfigureParams.Boot));
+	MemorySnapShot_Store(&ConfigureParams.SCSI, sizeof(ConfigureParams.SCSI));
+	MemorySnapShot_Store(&ConfigureParams.MO, sizeof(ConfigureParams.MO));
+	MemorySnapShot_Store(&ConfigureParams.Floppy, sizeof(ConfigureParams.Floppy));
+	MemorySnapShot_Store(&ConfigureParams.Ethernet, sizeof(ConfigureParams.Ethernet));
+	MemorySnapShot_Store(&ConfigureParams.Printer, sizeof(ConfigureParams.Printer));
+	MemorySnapShot_Store(&ConfigureParams.Dimension, sizeof(ConfigureParams.Dimension));
+}
@@ -35,6 +35,7 @@
 #include "memory.h"
 #include "newcpu.h"
 #include "cpummu.h"
+#include "memorySnapShot.h"
 
 #define MMUDUMP 0
 
@@ -1073,6 +1074,25 @@ void REGPARAM2 mmu_set_super(bool super)
     mmu_is_super = super ? 0x80000000 : 0;
 }
 
+/*
+ * Save/Restore MMU state and ATC contents. The translation control
+ * register itself is part of regs.
+ */
+void mmu_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(&mmu_is_super, sizeof(mmu_is_super));
+    MemorySnapShot_Store(&mmu_tagmask, sizeof(mmu_tagmask));
+    MemorySnapShot_Store(&mmu_pagemask, sizeof(mmu_pagemask));
+    MemorySnapShot_Store(&mmu_pagemaski, sizeof(mmu_pagemaski));
+    MemorySnapShot_Store(&mmu_pagesize_8k, sizeof(mmu_pagesize_8k));
+    MemorySnapShot_Store(mmu_atc_array, sizeof(mmu_atc_array));
+    MemorySnapShot_Store(mmu_atc_ways, sizeof(mmu_atc_ways));
+    MemorySnapShot_Store(&way_random, sizeof(way_random));
+    MemorySnapShot_Store(&mmu040_movem, sizeof(mmu040_movem));
+    MemorySnapShot_Store(&mmu040_movem_ea, sizeof(mmu040_movem_ea));
+    MemorySnapShot_Store(mmu040_move16, sizeof(mmu040_move16));
+}
+
 void m68k_do_rte_mmu040 (uaecptr a7)
 {
     uae_u16 ssr = get_word_mmu040 (a7 + 8 + 4);
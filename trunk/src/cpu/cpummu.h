@@ -243,6 +243,7 @@ extern void REGPARAM3 mmu_reset(void) REGPARAM;
 extern void REGPARAM3 mmu_set_funcs(void) REGPARAM;
 extern void REGPARAM3 mmu_set_tc(uae_u16 tc) REGPARAM;
 extern void REGPARAM3 mmu_set_super(bool super) REGPARAM;
+extern void mmu_MemorySnapShot_Capture(bool bSave);
 
 static ALWAYS_INLINE int mmu_get_fc(bool super, bool data)
 {
@@ -39,6 +39,7 @@
 #include "memory.h"
 #include "newcpu.h"
 #include "cpummu030.h"
+#include "memorySnapShot.h"
 
 #define MMU030_OP_DBG_MSG 0
 #define MMU030_ATC_DBG_MSG 0
@@ -142,6 +143,112 @@ static struct {
 } mmu030;
 
 
+/* Software TLB
+ *
+ * Direct mapped cache of ATC entries which translate to plain memory
+ * (RAM, ROM or VRAM). It maps logical pages straight to host addresses
+ * for each function code. Every entry mirrors a valid ATC entry and must
+ * be invalidated together with it. Translations to device space, memory
+ * write function banks and pages causing bus errors are never cached.
+ */
+#define MMU030_TLB_SIZE     256
+#define MMU030_TLB_MASK     (MMU030_TLB_SIZE-1)
+#define MMU030_TLB_VALID    0x00000001 /* page addresses have bits 0-7 cleared */
+
+typedef struct {
+    uae_u32 tag;        /* logical page address | MMU030_TLB_VALID */
+    uae_u8* host_r;     /* host address of page for reads or NULL */
+    uae_u8* host_w;     /* host address of page for writes or NULL */
+} MMU030_TLB_ENTRY;
+
+static MMU030_TLB_ENTRY mmu030_tlb[8][MMU030_TLB_SIZE];
+
+MMU030_IFETCH mmu030_ifetch;
+
+static ALWAYS_INLINE MMU030_TLB_ENTRY* mmu030_tlb_entry(uaecptr addr, uae_u32 fc) {
+    return &mmu030_tlb[fc&7][(addr >> mmu030.translation.page.size) & MMU030_TLB_MASK];
+}
+
+/* Return host address for logical address or NULL if not in TLB.
+ * Accesses crossing the end of the page always take the slow path. */
+static ALWAYS_INLINE uae_u8* mmu030_tlb_get(uaecptr addr, uae_u32 fc, int size, bool write) {
+    MMU030_TLB_ENTRY* e = mmu030_tlb_entry(addr, fc);
+    uae_u32 page_index = addr & mmu030.translation.page.mask;
+    
+    if (e->tag == ((addr & mmu030.translation.page.imask) | MMU030_TLB_VALID) &&
+        page_index + size - 1 <= mmu030.translation.page.mask) {
+        uae_u8* host = write ? e->host_w : e->host_r;
+        if (host)
+            return host + page_index;
+    }
+    return NULL;
+}
+
+/* Create TLB entry from ATC entry l */
+static void mmu030_tlb_fill(uaecptr addr, uae_u32 fc, int l) {
+    MMU030_TLB_ENTRY* e = mmu030_tlb_entry(addr, fc);
+    uaecptr physical_addr = mmu030.atc[l].physical.addr & mmu030.translation.page.imask;
+    
+    if (mmu030.atc[l].physical.bus_error) {
+        e->tag = 0;
+        return;
+    }
+    e->tag    = (addr & mmu030.translation.page.imask) | MMU030_TLB_VALID;
+    e->host_r = get_bank_hostptr(bank_hostptr_r, physical_addr);
+    /* Writes to pages without modified bit must update the descriptor */
+    if (mmu030.atc[l].physical.write_protect || !mmu030.atc[l].physical.modified)
+        e->host_w = NULL;
+    else
+        e->host_w = get_bank_hostptr(bank_hostptr_w, physical_addr);
+}
+
+/* Point instruction fetch cache to TLB entry of addr */
+static void mmu030_ifetch_fill(uaecptr addr, uae_u32 fc) {
+    MMU030_TLB_ENTRY* e = mmu030_tlb_entry(addr, fc);
+    
+    if (e->tag == ((addr & mmu030.translation.page.imask) | MMU030_TLB_VALID) && e->host_r) {
+        mmu030_ifetch.tag  = (addr & mmu030.translation.page.imask) | fc | MMU030_IFETCH_VALID;
+        mmu030_ifetch.mask = mmu030.translation.page.mask;
+        mmu030_ifetch.host = e->host_r;
+    }
+}
+
+/* Point instruction fetch cache to untranslated bank of addr */
+static void mmu030_ifetch_fill_phys(uaecptr addr, uae_u32 fc) {
+    uae_u8* host = get_mem_bank(bank_hostptr_r, addr);
+    
+    if (host) {
+        mmu030_ifetch.tag  = (addr & ~0xFFFF) | fc | MMU030_IFETCH_VALID;
+        mmu030_ifetch.mask = 0xFFFF;
+        mmu030_ifetch.host = host;
+    }
+}
+
+/* Invalidate TLB entry for logical page */
+static void mmu030_tlb_flush_page(uaecptr logical_addr, uae_u32 fc) {
+    MMU030_TLB_ENTRY* e = mmu030_tlb_entry(logical_addr, fc);
+    
+    mmu030_ifetch.tag = 0;
+    if (e->tag == ((logical_addr & mmu030.translation.page.imask) | MMU030_TLB_VALID))
+        e->tag = 0;
+}
+
+/* Invalidate TLB entries for all function codes matching fc_base and fc_mask */
+static void mmu030_tlb_flush_fc(uae_u32 fc_base, uae_u32 fc_mask) {
+    int fc;
+    mmu030_ifetch.tag = 0;
+    for (fc=0; fc<8; fc++) {
+        if ((fc_base&fc_mask)==(fc&fc_mask))
+            memset(mmu030_tlb[fc], 0, sizeof(mmu030_tlb[fc]));
+    }
+}
+
+static void mmu030_tlb_flush_all(void) {
+    mmu030_ifetch.tag = 0;
+    memset(mmu030_tlb, 0, sizeof(mmu030_tlb));
+}
+
+
 
 /* MMU Status Register
  *
@@ -275,6 +382,7 @@ bool mmu_op30_pmove (uaecptr pc, uae_u32 opcode, uae_u16 next, uaecptr extra)
                 x_put_long (extra, tc_030);
             else {
                 tc_030 = x_get_long (extra);
+                mmu030_tlb_flush_all();
                 if (mmu030_decode_tc(tc_030))
 					return true;
             }
@@ -334,6 +442,9 @@ bool mmu_op30_pmove (uaecptr pc, uae_u32 opcode, uae_u16 next, uaecptr extra)
     
     if (!fd && !rw && preg != 0x18) {
         mmu030_flush_atc_all();
+    } else if (!rw && preg != 0x18) {
+        /* TLB bypasses transparent translation checks and depends on page size */
+        mmu030_tlb_flush_all();
     }
 	tt_enabled = (tt0_030 & TT_ENABLE) || (tt1_030 & TT_ENABLE);
 	return false;
@@ -465,6 +576,7 @@ bool mmu_op30_pflush (uaecptr pc, uae_u32 opcode, uae_u16 next, uaecptr extra)
 /* This function flushes ATC entries depending on their function code */
 void mmu030_flush_atc_fc(uae_u32 fc_base, uae_u32 fc_mask) {
     int i;
+    mmu030_tlb_flush_fc(fc_base, fc_mask);
     for (i=0; i<ATC030_NUM_ENTRIES; i++) {
         if (((fc_base&fc_mask)==(mmu030.atc[i].logical.fc&fc_mask)) &&
             mmu030.atc[i].logical.valid) {
@@ -486,6 +598,7 @@ void mmu030_flush_atc_page_fc(uaecptr logical_addr, uae_u32 fc_base, uae_u32 fc_
             (mmu030.atc[i].logical.addr == logical_addr) &&
             mmu030.atc[i].logical.valid) {
             mmu030.atc[i].logical.valid = false;
+            mmu030_tlb_flush_page(logical_addr, mmu030.atc[i].logical.fc);
 #if MMU030_OP_DBG_MSG
             write_log(_T("ATC: Flushing %08X\n"), mmu030.atc[i].physical.addr);
 #endif
@@ -501,6 +614,7 @@ void mmu030_flush_atc_page(uaecptr logical_addr) {
         if ((mmu030.atc[i].logical.addr == logical_addr) &&
             mmu030.atc[i].logical.valid) {
             mmu030.atc[i].logical.valid = false;
+            mmu030_tlb_flush_page(logical_addr, mmu030.atc[i].logical.fc);
 #if MMU030_OP_DBG_MSG
             write_log(_T("ATC: Flushing %08X\n"), mmu030.atc[i].physical.addr);
 #endif
@@ -517,6 +631,7 @@ void mmu030_flush_atc_all(void) {
     for (i=0; i<ATC030_NUM_ENTRIES; i++) {
         mmu030.atc[i].logical.valid = false;
     }
+    mmu030_tlb_flush_all();
 }
 
 
@@ -1524,6 +1639,10 @@ static uae_u32 mmu030_table_search(uaecptr addr, uae_u32 fc, bool write, int lev
 
     mmu030_atc_handle_history_bit(i);
     
+    /* Remove replaced entry from TLB */
+    if (mmu030.atc[i].logical.valid)
+        mmu030_tlb_flush_page(mmu030.atc[i].logical.addr, mmu030.atc[i].logical.fc);
+    
     /* Create ATC entry */
     mmu030.atc[i].logical.addr = addr & mmu030.translation.page.imask; /* delete page index bits */
     mmu030.atc[i].logical.fc = fc;
@@ -1881,6 +2000,7 @@ int mmu030_logical_is_in_atc(uaecptr addr, uae_u32 fc, bool write) {
 					return index;
 				} else {
 					mmu030.atc[index].logical.valid = false;
+					mmu030_tlb_flush_page(maddr, fc);
 				}
 		}
 		index++;
@@ -1919,6 +2039,12 @@ void mmu030_atc_handle_history_bit(int entry_num) {
 
 void mmu030_put_long(uaecptr addr, uae_u32 val, uae_u32 fc) {
     
+    uae_u8* host = mmu030_tlb_get(addr, fc, 4, true);
+    if (host) {
+        do_put_mem_long(host, val);
+        return;
+    }
+    
     //                                      addr,fc,write
     if ((fc==7) || (mmu030_match_ttr_access(addr,fc,true)) || (!mmu030.enabled)) {
         phys_put_long(addr,val);
@@ -1927,16 +2053,22 @@ void mmu030_put_long(uaecptr addr, uae_u32 val, uae_u32 fc) {
 
     int atc_line_num = mmu030_logical_is_in_atc(addr, fc, true);
 
-    if (atc_line_num>=0) {
-        mmu030_put_long_atc(addr, val, atc_line_num, fc);
-    } else {
-        mmu030_table_search(addr,fc,true,0);
-        mmu030_put_long_atc(addr, val, mmu030_logical_is_in_atc(addr,fc,true), fc);
+    if (atc_line_num<0) {
+        mmu030_table_search(addr, fc, true, 0);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, true);
     }
+    mmu030_put_long_atc(addr, val, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
 }
 
 void mmu030_put_word(uaecptr addr, uae_u16 val, uae_u32 fc) {
     
+    uae_u8* host = mmu030_tlb_get(addr, fc, 2, true);
+    if (host) {
+        do_put_mem_word(host, val);
+        return;
+    }
+    
     //                                      addr,fc,write
     if ((fc==7) || (mmu030_match_ttr_access(addr,fc,true)) || (!mmu030.enabled)) {
         phys_put_word(addr,val);
@@ -1945,16 +2077,22 @@ void mmu030_put_word(uaecptr addr, uae_u16 val, uae_u32 fc) {
     
     int atc_line_num = mmu030_logical_is_in_atc(addr, fc, true);
     
-    if (atc_line_num>=0) {
-        mmu030_put_word_atc(addr, val, atc_line_num, fc);
-    } else {
+    if (atc_line_num<0) {
         mmu030_table_search(addr, fc, true, 0);
-        mmu030_put_word_atc(addr, val, mmu030_logical_is_in_atc(addr,fc,true), fc);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, true);
     }
+    mmu030_put_word_atc(addr, val, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
 }
 
 void mmu030_put_byte(uaecptr addr, uae_u8 val, uae_u32 fc) {
     
+    uae_u8* host = mmu030_tlb_get(addr, fc, 1, true);
+    if (host) {
+        *host = val;
+        return;
+    }
+    
     //                                      addr,fc,write
     if ((fc==7) || (mmu030_match_ttr_access(addr,fc,true)) || (!mmu030.enabled)) {
         phys_put_byte(addr,val);
@@ -1963,32 +2101,43 @@ void mmu030_put_byte(uaecptr addr, uae_u8 val, uae_u32 fc) {
     
     int atc_line_num = mmu030_logical_is_in_atc(addr, fc, true);
 
-    if (atc_line_num>=0) {
-        mmu030_put_byte_atc(addr, val, atc_line_num, fc);
-    } else {
+    if (atc_line_num<0) {
         mmu030_table_search(addr, fc, true, 0);
-        mmu030_put_byte_atc(addr, val, mmu030_logical_is_in_atc(addr,fc,true), fc);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, true);
     }
+    mmu030_put_byte_atc(addr, val, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
 }
 
 uae_u32 mmu030_get_ilong(uaecptr addr, uae_u32 fc) {
+    uae_u8* host = mmu030_tlb_get(addr, fc, 4, false);
+    if (host) {
+        mmu030_ifetch_fill(addr, fc);
+        return do_get_mem_long(host);
+    }
     
     //                                        addr,fc,write
     if ((fc == 7) || (mmu030_match_ttr_access(addr,fc,false)) || (!mmu030.enabled)) {
+        mmu030_ifetch_fill_phys(addr, fc);
         return phys_get_long(addr);
     }
     
-	int atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
-
-	if (atc_line_num >= 0) {
-		return mmu030_get_ilong_atc(addr, atc_line_num, fc);
-	}
-	else {
-		mmu030_table_search(addr, fc, false, 0);
-		return mmu030_get_ilong_atc(addr, mmu030_logical_is_in_atc(addr, fc, false), fc);
-	}
+    int atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
+    
+    if (atc_line_num<0) {
+        mmu030_table_search(addr, fc, false, 0);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
+    }
+    uae_u32 val = mmu030_get_ilong_atc(addr, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
+    mmu030_ifetch_fill(addr, fc);
+    return val;
 }
 uae_u32 mmu030_get_long(uaecptr addr, uae_u32 fc) {
+    uae_u8* host = mmu030_tlb_get(addr, fc, 4, false);
+    if (host) {
+        return do_get_mem_long(host);
+    }
     
     //                                      addr,fc,write
     if ((fc==7) || (mmu030_match_ttr_access(addr,fc,false)) || (!mmu030.enabled)) {
@@ -1996,32 +2145,45 @@ uae_u32 mmu030_get_long(uaecptr addr, uae_u32 fc) {
     }
     
     int atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
-
-    if (atc_line_num>=0) {
-        return mmu030_get_long_atc(addr, atc_line_num, fc);
-    } else {
+    
+    if (atc_line_num<0) {
         mmu030_table_search(addr, fc, false, 0);
-        return mmu030_get_long_atc(addr, mmu030_logical_is_in_atc(addr,fc,false), fc);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
     }
+    uae_u32 val = mmu030_get_long_atc(addr, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
+    return val;
 }
 
 uae_u16 mmu030_get_iword(uaecptr addr, uae_u32 fc) {
+    uae_u8* host = mmu030_tlb_get(addr, fc, 2, false);
+    if (host) {
+        mmu030_ifetch_fill(addr, fc);
+        return do_get_mem_word(host);
+    }
     
     //                                        addr,fc,write
     if ((fc == 7) || (mmu030_match_ttr_access(addr,fc,false)) || (!mmu030.enabled)) {
+        mmu030_ifetch_fill_phys(addr, fc);
         return phys_get_word(addr);
     }
     
-	int atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
-
-	if (atc_line_num >= 0) {
-		return mmu030_get_iword_atc(addr, atc_line_num, fc);
-	} else {
-		mmu030_table_search(addr, fc, false, 0);
-		return mmu030_get_iword_atc(addr, mmu030_logical_is_in_atc(addr, fc, false), fc);
-	}
+    int atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
+    
+    if (atc_line_num<0) {
+        mmu030_table_search(addr, fc, false, 0);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
+    }
+    uae_u16 val = mmu030_get_iword_atc(addr, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
+    mmu030_ifetch_fill(addr, fc);
+    return val;
 }
 uae_u16 mmu030_get_word(uaecptr addr, uae_u32 fc) {
+    uae_u8* host = mmu030_tlb_get(addr, fc, 2, false);
+    if (host) {
+        return do_get_mem_word(host);
+    }
     
     //                                      addr,fc,write
     if ((fc==7) || (mmu030_match_ttr_access(addr,fc,false)) || (!mmu030.enabled)) {
@@ -2029,16 +2191,21 @@ uae_u16 mmu030_get_word(uaecptr addr, uae_u32 fc) {
     }
     
     int atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
-
-    if (atc_line_num>=0) {
-        return mmu030_get_word_atc(addr, atc_line_num, fc);
-    } else {
+    
+    if (atc_line_num<0) {
         mmu030_table_search(addr, fc, false, 0);
-        return mmu030_get_word_atc(addr, mmu030_logical_is_in_atc(addr,fc,false), fc);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
     }
+    uae_u16 val = mmu030_get_word_atc(addr, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
+    return val;
 }
 
 uae_u8 mmu030_get_byte(uaecptr addr, uae_u32 fc) {
+    uae_u8* host = mmu030_tlb_get(addr, fc, 1, false);
+    if (host) {
+        return *host;
+    }
     
     //                                      addr,fc,write
     if ((fc==7) || (mmu030_match_ttr_access(addr,fc,false)) || (!mmu030.enabled)) {
@@ -2046,13 +2213,14 @@ uae_u8 mmu030_get_byte(uaecptr addr, uae_u32 fc) {
     }
     
     int atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
-
-    if (atc_line_num>=0) {
-        return mmu030_get_byte_atc(addr, atc_line_num, fc);
-    } else {
+    
+    if (atc_line_num<0) {
         mmu030_table_search(addr, fc, false, 0);
-        return mmu030_get_byte_atc(addr, mmu030_logical_is_in_atc(addr,fc,false), fc);
+        atc_line_num = mmu030_logical_is_in_atc(addr, fc, false);
     }
+    uae_u8 val = mmu030_get_byte_atc(addr, atc_line_num, fc);
+    mmu030_tlb_fill(addr, fc, atc_line_num);
+    return val;
 }
 
 
@@ -2315,6 +2483,7 @@ void mmu030_reset(int hardreset)
 	tc_030 &= ~TC_ENABLE_TRANSLATION;
 	tt0_030 &= ~TT_ENABLE;
 	tt1_030 &= ~TT_ENABLE;
+	mmu030_tlb_flush_all();
 	if (hardreset) {
 		srp_030 = crp_030 = 0;
 		tt0_030 = tt1_030 = tc_030 = 0;
@@ -2330,6 +2499,33 @@ void mmu030_set_funcs(void)
 		return;
 }
 
+/* Save/Restore MMU registers, ATC and the state needed to restart
+ * an instruction. The software TLB is rebuilt from the ATC on demand. */
+void mmu030_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(&mmu030, sizeof(mmu030));
+    MemorySnapShot_Store(&srp_030, sizeof(srp_030));
+    MemorySnapShot_Store(&crp_030, sizeof(crp_030));
+    MemorySnapShot_Store(&tt0_030, sizeof(tt0_030));
+    MemorySnapShot_Store(&tt1_030, sizeof(tt1_030));
+    MemorySnapShot_Store(&tc_030, sizeof(tc_030));
+    MemorySnapShot_Store(&mmusr_030, sizeof(mmusr_030));
+    MemorySnapShot_Store(atcindextable, sizeof(atcindextable));
+    MemorySnapShot_Store(&tt_enabled, sizeof(tt_enabled));
+    MemorySnapShot_Store(&mmu030_idx, sizeof(mmu030_idx));
+    MemorySnapShot_Store(&mmu030_opcode, sizeof(mmu030_opcode));
+    MemorySnapShot_Store(&mmu030_fake_prefetch, sizeof(mmu030_fake_prefetch));
+    MemorySnapShot_Store(&mmu030_fake_prefetch_addr, sizeof(mmu030_fake_prefetch_addr));
+    MemorySnapShot_Store(mmu030_state, sizeof(mmu030_state));
+    MemorySnapShot_Store(&mmu030_data_buffer, sizeof(mmu030_data_buffer));
+    MemorySnapShot_Store(mmu030_disp_store, sizeof(mmu030_disp_store));
+    MemorySnapShot_Store(mmu030_fmovem_store, sizeof(mmu030_fmovem_store));
+    MemorySnapShot_Store(mmu030_ad, sizeof(mmu030_ad));
+    
+    if (!bSave)
+        mmu030_tlb_flush_all();
+}
+
 
 void m68k_do_rte_mmu030 (uaecptr a7)
 {
@@ -69,6 +69,7 @@ void mmu030_flush_atc_page_fc(uaecptr logical_addr, uae_u32 fc_base, uae_u32 fc_
 void mmu030_flush_atc_all(void);
 void mmu030_reset(int hardreset);
 void mmu030_set_funcs(void);
+void mmu030_MemorySnapShot_Capture(bool bSave);
 uaecptr mmu030_translate(uaecptr addr, bool super, bool data, bool write);
 
 int mmu030_match_ttr(uaecptr addr, uae_u32 fc, bool write);
@@ -86,6 +87,33 @@ uae_u8  mmu030_get_byte(uaecptr addr, uae_u32 fc);
 uae_u32 mmu030_get_ilong(uaecptr addr, uae_u32 fc);
 uae_u16 mmu030_get_iword(uaecptr addr, uae_u32 fc);
 
+/* Instruction fetch cache
+ *
+ * Host address of the page the CPU is currently executing from. It is
+ * taken from the software TLB or the bank host pointers and invalidated
+ * together with the TLB. Only the location of the code is cached, not the
+ * instruction words, so writes to code pages need no invalidation.
+ */
+#define MMU030_IFETCH_VALID 0x08 /* bits 0-2 hold the function code */
+
+typedef struct {
+    uae_u32 tag;        /* logical page address | fc | MMU030_IFETCH_VALID */
+    uae_u32 mask;       /* page offset mask */
+    uae_u8* host;       /* host address of page */
+} MMU030_IFETCH;
+
+extern MMU030_IFETCH mmu030_ifetch;
+
+static ALWAYS_INLINE uae_u8* mmu030_ifetch_get(uaecptr addr, uae_u32 fc, int size)
+{
+    uae_u32 page_index = addr & mmu030_ifetch.mask;
+
+    if (((addr & ~mmu030_ifetch.mask) | fc | MMU030_IFETCH_VALID) == mmu030_ifetch.tag &&
+        page_index + size - 1 <= mmu030_ifetch.mask)
+        return mmu030_ifetch.host + page_index;
+    return NULL;
+}
+
 uae_u32 uae_mmu030_get_lrmw(uaecptr addr, int size);
 void uae_mmu030_put_lrmw(uaecptr addr, uae_u32 val, int size);
 
@@ -103,7 +131,10 @@ extern void REGPARAM3 mmu030_put_long_unaligned(uaecptr addr, uae_u32 val, uae_u
 static ALWAYS_INLINE uae_u32 uae_mmu030_get_ilong(uaecptr addr)
 {
     uae_u32 fc = (regs.s ? 4 : 0) | 2;
+	uae_u8* host = mmu030_ifetch_get(addr, fc, 4);
 
+	if (likely(host))
+		return do_get_mem_long(host);
 	if (unlikely(is_unaligned(addr, 4)))
 		return mmu030_get_ilong_unaligned(addr, fc, 0);
 	return mmu030_get_ilong(addr, fc);
@@ -111,6 +142,10 @@ static ALWAYS_INLINE uae_u32 uae_mmu030_get_ilong(uaecptr addr)
 static ALWAYS_INLINE uae_u16 uae_mmu030_get_iword(uaecptr addr)
 {
     uae_u32 fc = (regs.s ? 4 : 0) | 2;
+	uae_u8* host = mmu030_ifetch_get(addr, fc, 2);
+
+	if (likely(host))
+		return do_get_mem_word(host);
 	return mmu030_get_iword(addr, fc);
 }
 static ALWAYS_INLINE uae_u16 uae_mmu030_get_ibyte(uaecptr addr)
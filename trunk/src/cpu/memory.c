@@ -18,6 +18,7 @@ const char Memory_fileid[] = "Previous memory.c : " __DATE__ " " __TIME__;
 #include "hatari-glue.h"
 #include "maccess.h"
 #include "memory.h"
+#include "memory_mwf.h"
 
 #include "main.h"
 #include "ioMem.h"
@@ -30,6 +31,7 @@ const char Memory_fileid[] = "Previous memory.c : " __DATE__ " " __TIME__;
 #include "NextBus.hpp"
 
 #include "newcpu.h"
+#include "memorySnapShot.h"
 
 
 /* Set illegal_mem to 1 for debug output: */
@@ -501,6 +503,50 @@ static void mem_ram_empty_bput(uaecptr addr, uae_u32 b)
 }
 
 
+/* **** NEXT VRAM dirty scanline tracking **** */
+
+/* One bit per scanline of the main framebuffer. Set by the VRAM write
+ * functions on the m68k thread, fetched and cleared by the repaint thread.
+ * The release barrier makes the pixel data visible before the bit. The bit
+ * is set with a plain store: if it races with the fetch in the repainter,
+ * the bit is set again and the line is converted once more in the next
+ * frame, but never lost. */
+static atomic_int NEXTVideoDirty[NEXT_VIDEO_DIRTY_WORDS];
+static uae_u32    NEXTVideoLineBytes = 288;
+
+static inline void mem_video_dirty(uae_u32 addr, int size)
+{
+	uae_u32 line = addr / NEXTVideoLineBytes;
+	uae_u32 last = (addr + size - 1) / NEXTVideoLineBytes;
+	
+	SDL_MemoryBarrierRelease();
+	for (; line <= last && line < NEXT_VIDEO_LINES; line++)
+		NEXTVideoDirty[line >> 5].value |= (int)(1u << (line & 31));
+}
+
+/* Fetch and clear the dirty scanline bits, return true if any was set */
+bool memory_video_get_dirty(uae_u32 *lines)
+{
+	uae_u32 any = 0;
+	int i;
+	
+	for (i = 0; i < NEXT_VIDEO_DIRTY_WORDS; i++) {
+		lines[i] = host_atomic_set(&NEXTVideoDirty[i], 0);
+		any |= lines[i];
+	}
+	return any != 0;
+}
+
+/* Mark the whole framebuffer dirty */
+void memory_video_set_dirty(void)
+{
+	int i;
+	
+	for (i = 0; i < NEXT_VIDEO_DIRTY_WORDS; i++)
+		host_atomic_set(&NEXTVideoDirty[i], -1);
+}
+
+
 /* **** NEXT VRAM memory for monochrome systems **** */
 
 static uae_u32 mem_video_lget(uaecptr addr)
@@ -525,95 +571,26 @@ static void mem_video_lput(uaecptr addr, uae_u32 l)
 {
 	addr &= NEXT_VRAM_MASK;
 	do_put_mem_long(NEXTVideo + addr, l);
+	mem_video_dirty(addr, 4);
 }
 
 static void mem_video_wput(uaecptr addr, uae_u32 w)
 {
 	addr &= NEXT_VRAM_MASK;
 	do_put_mem_word(NEXTVideo + addr, w);
+	mem_video_dirty(addr, 2);
 }
 
 static void mem_video_bput(uaecptr addr, uae_u32 b)
 {
 	addr &= NEXT_VRAM_MASK;
 	NEXTVideo[addr] = b;
+	mem_video_dirty(addr, 1);
 }
 
 
 /* **** NEXT memory banks with write functions **** */
 
-static uae_u8 mwf0[4][4] = { /* AB */
-	{ 0, 0, 0, 0 },
-	{ 0, 0, 1, 1 },
-	{ 0, 1, 1, 2 },
-	{ 0, 1, 2, 3 }
-};
-
-static uae_u8 mwf1[4][4] = { /* ceil(A+B) */
-	{ 0, 1, 2, 3 },
-	{ 1, 2, 3, 3 },
-	{ 2, 3, 3, 3 },
-	{ 3, 3, 3, 3 }
-};
-
-static uae_u8 mwf2[4][4] = { /* (1-A)B */
-	{ 0, 0, 0, 0 },
-	{ 1, 1, 0, 0 },
-	{ 2, 1, 1, 0 },
-	{ 3, 2, 1, 0 }
-};
-
-static uae_u8 mwf3[4][4] = { /* A+B-AB */
-	{ 0, 1, 2, 3 },
-	{ 1, 2, 2, 3 },
-	{ 2, 2, 3, 3 },
-	{ 3, 3, 3, 3 }
-};
-
-static uae_u32 memory_write_func(uae_u32 old, uae_u32 new, int function, int size)
-{
-	int a,b,i;
-	uae_u32 v=0;
-#if 0
-	write_log("[MWF] Function%i: size=%i, old=%08X, new=%08X\n",function,size,old,new);
-#endif
-	
-	switch (function) {
-		case 0:
-			for (i=0; i<(size*4); i++) {
-				a=old>>(i*2)&3;
-				b=new>>(i*2)&3;
-				v|=mwf0[a][b]<<(i*2);
-			}
-			return v;
-		case 1:
-			for (i=0; i<(size*4); i++) {
-				a=old>>(i*2)&3;
-				b=new>>(i*2)&3;
-				v|=mwf1[a][b]<<(i*2);
-			}
-			return v;
-		case 2:
-			for (i=0; i<(size*4); i++) {
-				a=old>>(i*2)&3;
-				b=new>>(i*2)&3;
-				v|=mwf2[a][b]<<(i*2);
-			}
-			return v;
-		case 3:
-			for (i=0; i<(size*4); i++) {
-				a=old>>(i*2)&3;
-				b=new>>(i*2)&3;
-				v|=mwf3[a][b]<<(i*2);
-			}
-			return v;
-			
-		default:
-			write_log("Unknown memory write function!\n");
-			abort();
-	}
-}
-
 static uae_u32 mem_ram_mwf_lget(uaecptr addr)
 {
 	int function = (addr>>26)&0x3;
@@ -754,18 +731,21 @@ static void mem_color_video_lput(uaecptr addr, uae_u32 l)
 {
 	addr &= NEXT_VRAM_COLOR_MASK;
 	do_put_mem_long(NEXTVideo + addr, l);
+	mem_video_dirty(addr, 4);
 }
 
 static void mem_color_video_wput(uaecptr addr, uae_u32 w)
 {
 	addr &= NEXT_VRAM_COLOR_MASK;
 	do_put_mem_word(NEXTVideo + addr, w);
+	mem_video_dirty(addr, 2);
 }
 
 static void mem_color_video_bput(uaecptr addr, uae_u32 b)
 {
 	addr &= NEXT_VRAM_COLOR_MASK;
 	NEXTVideo[addr] = b;
+	mem_video_dirty(addr, 1);
 }
 
 
@@ -972,9 +952,24 @@ static void init_mem_banks (void)
         put_mem_bank (bank_lput, i<<16, BusErrMem_bank.lput);
         put_mem_bank (bank_wput, i<<16, BusErrMem_bank.wput);
         put_mem_bank (bank_bput, i<<16, BusErrMem_bank.bput);
+        put_mem_bank (bank_hostptr_r, i<<16, NULL);
+        put_mem_bank (bank_hostptr_w, i<<16, NULL);
     }
 }
 
+/* Set host addresses for banks that map plain memory. Must be called
+ * after map_banks with the same start and size. The mask is the one used
+ * by the bank access functions. */
+static void map_banks_hostptr (uae_u8 *base, uae_u32 mask, int start, int size, bool writable)
+{
+	int bnr;
+	
+	for (bnr = start; bnr < start + size; bnr++) {
+		put_mem_bank (bank_hostptr_r, bnr << 16, base + ((bnr << 16) & mask));
+		put_mem_bank (bank_hostptr_w, bnr << 16, writable ? base + ((bnr << 16) & mask) : NULL);
+	}
+}
+
 // Arrays are ordered by access probability from profiling data
 // keep them in these order for cache locality
 
@@ -987,6 +982,9 @@ mem_put_func bank_lput[65536];
 mem_get_func bank_bget[65536];
 mem_put_func bank_bput[65536];
 
+uae_u8* bank_hostptr_r[65536];
+uae_u8* bank_hostptr_w[65536];
+
 /*
  * Initialize the memory banks
  */
@@ -1026,9 +1024,11 @@ const char* memory_init(int *nNewNEXTMemSize)
 	
 	/* Map ROM */
 	map_banks(&ROM_bank, NEXT_EPROM_START >> 16, NEXT_EPROM_SIZE>>16);
+	map_banks_hostptr(NEXTRom, NEXT_EPROM_MASK, NEXT_EPROM_START >> 16, NEXT_EPROM_SIZE>>16, false);
 	write_log("Mapping ROM at $%08x: %ikB\n", NEXT_EPROM_START, NEXT_EPROM_SIZE/1024);
 	if (ConfigureParams.System.nMachineType != NEXT_CUBE030) {
 		map_banks(&ROM_bank, NEXT_EPROM_BMAP_START >> 16, NEXT_EPROM_SIZE>>16);
+		map_banks_hostptr(NEXTRom, NEXT_EPROM_MASK, NEXT_EPROM_BMAP_START >> 16, NEXT_EPROM_SIZE>>16, false);
 		write_log("Mapping ROM trough BMAP at $%08x: %ikB\n", NEXT_EPROM_BMAP_START, NEXT_EPROM_SIZE/1024);
 	}
 	
@@ -1036,6 +1036,7 @@ const char* memory_init(int *nNewNEXTMemSize)
 	if (nNewNEXTMemSize[0]) {
 		NEXT_ram_bank0_mask = NEXT_ram_bank_mask|((nNewNEXTMemSize[0]<<20)-1);
 		map_banks(&RAM_bank0, bankstart[0]>>16, NEXT_ram_bank_size >> 16);
+		map_banks_hostptr(NEXTRam, NEXT_ram_bank0_mask, bankstart[0]>>16, NEXT_ram_bank_size >> 16, true);
 		write_log("Mapping main memory bank0 at $%08x: %iMB\n", bankstart[0], nNewNEXTMemSize[0]);
 	} else {
 		NEXT_ram_bank0_mask = 0;
@@ -1046,6 +1047,7 @@ const char* memory_init(int *nNewNEXTMemSize)
 	if (nNewNEXTMemSize[1]) {
 		NEXT_ram_bank1_mask = NEXT_ram_bank_mask|((nNewNEXTMemSize[1]<<20)-1);
 		map_banks(&RAM_bank1, bankstart[1]>>16, NEXT_ram_bank_size >> 16);
+		map_banks_hostptr(NEXTRam, NEXT_ram_bank1_mask, bankstart[1]>>16, NEXT_ram_bank_size >> 16, true);
 		write_log("Mapping main memory bank1 at $%08x: %iMB\n", bankstart[1], nNewNEXTMemSize[1]);
 	} else {
 		NEXT_ram_bank1_mask = 0;
@@ -1056,6 +1058,7 @@ const char* memory_init(int *nNewNEXTMemSize)
 	if (nNewNEXTMemSize[2]) {
 		NEXT_ram_bank2_mask = NEXT_ram_bank_mask|((nNewNEXTMemSize[2]<<20)-1);
 		map_banks(&RAM_bank2, bankstart[2]>>16, NEXT_ram_bank_size >> 16);
+		map_banks_hostptr(NEXTRam, NEXT_ram_bank2_mask, bankstart[2]>>16, NEXT_ram_bank_size >> 16, true);
 		write_log("Mapping main memory bank2 at $%08x: %iMB\n", bankstart[2], nNewNEXTMemSize[2]);
 	} else {
 		NEXT_ram_bank2_mask = 0;
@@ -1066,6 +1069,7 @@ const char* memory_init(int *nNewNEXTMemSize)
 	if (nNewNEXTMemSize[3]) {
 		NEXT_ram_bank3_mask = NEXT_ram_bank_mask|((nNewNEXTMemSize[3]<<20)-1);
 		map_banks(&RAM_bank3, bankstart[3]>>16, NEXT_ram_bank_size >> 16);
+		map_banks_hostptr(NEXTRam, NEXT_ram_bank3_mask, bankstart[3]>>16, NEXT_ram_bank_size >> 16, true);
 		write_log("Mapping main memory bank3 at $%08x: %iMB\n", bankstart[3], nNewNEXTMemSize[3]);
 	} else {
 		NEXT_ram_bank3_mask = 0;
@@ -1073,6 +1077,8 @@ const char* memory_init(int *nNewNEXTMemSize)
 		write_log("Mapping main memory bank3 at $%08x: empty\n", bankstart[3]);
 	}
 	
+	memory_write_func_init();
+	
 	/* Map mirrors of main memory for memory write functions */
 	if (!ConfigureParams.System.bColor && !ConfigureParams.System.bTurbo) {
 		map_banks(&RAM_mwf_bank, NEXT_RAM_MWF0_START>>16, (NEXT_RAM_BANK_MAX*N_BANKS) >> 16);
@@ -1084,18 +1090,26 @@ const char* memory_init(int *nNewNEXTMemSize)
 			write_log("Function%i at $%08X\n",i,0x10000000+0x04000000*i);
 	}
 	
-	/* Map video memory */
+	/* Map video memory. Host pointers are read-only, so writes go through
+	 * the bank functions and update the dirty scanline bits. */
+	NEXTVideoLineBytes = NEXT_SCRN_LINE_BYTES(ConfigureParams.System.bColor, ConfigureParams.System.bTurbo);
+	memory_video_set_dirty();
+	
 	if (ConfigureParams.System.bTurbo && ConfigureParams.System.bColor) {
 		map_banks(&VRAM_color_bank, NEXT_VRAM_TURBO_START>>16, NEXT_VRAM_COLOR_SIZE >> 16);
+		map_banks_hostptr(NEXTVideo, NEXT_VRAM_COLOR_MASK, NEXT_VRAM_TURBO_START>>16, NEXT_VRAM_COLOR_SIZE >> 16, false);
 		write_log("Mapping video memory at $%08x: %ikB\n", NEXT_VRAM_TURBO_START, NEXT_VRAM_COLOR_SIZE/1024);
 	} else if (ConfigureParams.System.bTurbo) {
 		map_banks(&VRAM_bank, NEXT_VRAM_TURBO_START>>16, NEXT_VRAM_SIZE >> 16);
+		map_banks_hostptr(NEXTVideo, NEXT_VRAM_MASK, NEXT_VRAM_TURBO_START>>16, NEXT_VRAM_SIZE >> 16, false);
 		write_log("Mapping video memory at $%08x: %ikB\n", NEXT_VRAM_TURBO_START, NEXT_VRAM_SIZE/1024);
 	} else if (ConfigureParams.System.bColor) {
 		map_banks(&VRAM_color_bank, NEXT_VRAM_COLOR_START>>16, NEXT_VRAM_COLOR_SIZE >> 16);
+		map_banks_hostptr(NEXTVideo, NEXT_VRAM_COLOR_MASK, NEXT_VRAM_COLOR_START>>16, NEXT_VRAM_COLOR_SIZE >> 16, false);
 		write_log("Mapping video memory at $%08x: %ikB\n", NEXT_VRAM_COLOR_START, NEXT_VRAM_COLOR_SIZE/1024);
 	} else {
 		map_banks(&VRAM_bank, NEXT_VRAM_START>>16, NEXT_VRAM_SIZE >> 16);
+		map_banks_hostptr(NEXTVideo, NEXT_VRAM_MASK, NEXT_VRAM_START>>16, NEXT_VRAM_SIZE >> 16, false);
 		write_log("Mapping video memory at $%08x: %ikB\n", NEXT_VRAM_START, NEXT_VRAM_SIZE/1024);
 		
 		map_banks(&VRAM_mwf_bank, NEXT_VRAM_MWF0_START>>16, NEXT_VRAM_SIZE >> 16);
@@ -1221,6 +1235,21 @@ void memory_uninit (void)
 }
 
 
+/*
+ * Save/Restore snapshot of memory contents. The bank mapping is set up
+ * by memory_init from the restored configuration.
+ */
+void Memory_MemorySnapShot_Capture(bool bSave)
+{
+	MemorySnapShot_StorePages(NEXTRam, 128*1024*1024);
+	MemorySnapShot_StorePages(NEXTVideo, 2*1024*1024);
+	if (!bSave)
+		memory_video_set_dirty();
+	MemorySnapShot_Store(NEXTIo, 0x20000);
+	MemorySnapShot_Store(NEXTRom, NEXT_EPROM_SIZE);
+}
+
+
 void map_banks (addrbank *bank, int start, int size) {
 	int bnr;
 	
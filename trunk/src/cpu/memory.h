@@ -56,8 +56,29 @@ extern mem_put_func bank_bput[65536];
 #define get_mem_bank(bank, addr)    (bank[bankindex(addr)])
 #define put_mem_bank(bank, addr, b) (bank[bankindex(addr)] = (b))
 
+/* Host address of banks that map plain memory (RAM, ROM and VRAM), NULL for
+ * all other banks. Used by the MMU to bypass the bank access functions.
+ * VRAM has no write pointer, its writes must update the dirty scanlines. */
+extern uae_u8* bank_hostptr_r[65536];
+extern uae_u8* bank_hostptr_w[65536];
+
+#define get_bank_hostptr(bank, addr) ((bank)[bankindex(addr)] ? (bank)[bankindex(addr)] + ((addr) & 0xFFFF) : NULL)
+
+/* Dirty scanline bits of the main framebuffer, one bit per line */
+#define NEXT_VIDEO_LINES        832
+#define NEXT_VIDEO_DIRTY_WORDS  ((NEXT_VIDEO_LINES + 31) / 32)
+
+/* Bytes per framebuffer line including the invisible 32 pixels of
+ * non-Turbo systems: 2 bit per pixel for monochrome, 16 bit for color. */
+#define NEXT_SCRN_LINE_BYTES(color, turbo) \
+	(((color) ? 2 * 1120 : 1120 / 4) + ((turbo) ? 0 : ((color) ? 2 * 32 : 32 / 4)))
+
+bool memory_video_get_dirty(uae_u32 *lines);
+void memory_video_set_dirty(void);
+
 const char* memory_init(int *membanks);
 void memory_uninit (void);
+void Memory_MemorySnapShot_Capture(bool bSave);
 void map_banks(addrbank *bank, int first, int count);
 
 #define get_long(addr)   (call_mem_get_func(get_mem_bank(bank_lget, addr), addr))
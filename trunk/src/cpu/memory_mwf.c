@@ -0,0 +1,58 @@
+/*
+ * Previous - memory_mwf.c
+ *
+ * Memory write functions of the NeXT RAM and VRAM mirrors. A write to a
+ * mirror combines the new 2 bit pixels with the pixels in memory.
+ *
+ * This file is distributed under the GNU Public License, version 2 or at
+ * your option any later version. Read the file gpl.txt for details.
+ */
+const char MemoryMWF_fileid[] = "Previous memory_mwf.c : " __DATE__ " " __TIME__;
+
+#include "config.h"
+#include "sysdeps.h"
+#include "memory_mwf.h"
+
+const uae_u8 mwf_pixel[4][4][4] = {
+	{ /* AB */
+		{ 0, 0, 0, 0 },
+		{ 0, 0, 1, 1 },
+		{ 0, 1, 1, 2 },
+		{ 0, 1, 2, 3 }
+	},
+	{ /* ceil(A+B) */
+		{ 0, 1, 2, 3 },
+		{ 1, 2, 3, 3 },
+		{ 2, 3, 3, 3 },
+		{ 3, 3, 3, 3 }
+	},
+	{ /* (1-A)B */
+		{ 0, 0, 0, 0 },
+		{ 1, 1, 0, 0 },
+		{ 2, 1, 1, 0 },
+		{ 3, 2, 1, 0 }
+	},
+	{ /* A+B-AB */
+		{ 0, 1, 2, 3 },
+		{ 1, 2, 2, 3 },
+		{ 2, 2, 3, 3 },
+		{ 3, 3, 3, 3 }
+	}
+};
+
+uae_u8 mwf_nibble[4][256];
+
+void memory_write_func_init(void)
+{
+	int f, old, new;
+	
+	for (f = 0; f < 4; f++) {
+		for (old = 0; old < 16; old++) {
+			for (new = 0; new < 16; new++) {
+				mwf_nibble[f][(old << 4) | new] =
+					(mwf_pixel[f][old >> 2][new >> 2] << 2) |
+					 mwf_pixel[f][old & 3][new & 3];
+			}
+		}
+	}
+}
@@ -0,0 +1,39 @@
+ /*
+  * Previous - memory_mwf.h
+  *
+  * Memory write functions of the NeXT RAM and VRAM mirrors
+  *
+  * This file is distributed under the GNU Public License, version 2 or at
+  * your option any later version. Read the file gpl.txt for details.
+  */
+
+#ifndef UAE_MEMORY_MWF_H
+#define UAE_MEMORY_MWF_H
+
+#include "sysdeps.h"
+
+/* Result of the write functions for one 2 bit pixel, indexed by the
+ * function, the old and the new pixel. */
+extern const uae_u8 mwf_pixel[4][4][4];
+
+/* Results for two pixels at a time, indexed by the function and by the
+ * old and the new nibble. Built from mwf_pixel by memory_write_func_init. */
+extern uae_u8 mwf_nibble[4][256];
+
+void memory_write_func_init(void);
+
+static inline uae_u32 memory_write_func(uae_u32 old, uae_u32 new, int function, int size)
+{
+	const uae_u8 *lut = mwf_nibble[function];
+	uae_u32 v = 0;
+	int i;
+#if 0
+	write_log("[MWF] Function%i: size=%i, old=%08X, new=%08X\n",function,size,old,new);
+#endif
+	
+	for (i = 0; i < size * 8; i += 4)
+		v |= (uae_u32)lut[(((old >> i) & 0xF) << 4) | ((new >> i) & 0xF)] << i;
+	return v;
+}
+
+#endif /* UAE_MEMORY_MWF_H */
@@ -38,6 +38,7 @@
 #include "debugui.h"
 #include "debugcpu.h"
 #include "sysReg.h"
+#include "memorySnapShot.h"
 
 
 /* Opcode of faulting instruction */
@@ -1098,6 +1099,32 @@ void m68k_reset (int hardreset)
 	regs.pcr = 0;
 }
 
+/*
+ * Save/Restore CPU registers and caches. The PC is stored as plain
+ * address, the host pointers into the instruction stream are reset.
+ * SPCFLAG_MODE_CHANGE and SPCFLAG_BRK are kept from the running CPU.
+ */
+void m68k_MemorySnapShot_Capture (bool bSave)
+{
+	uae_u32 spcflags = regs.spcflags & (SPCFLAG_MODE_CHANGE | SPCFLAG_BRK);
+
+	if (bSave) {
+		MakeSR ();
+		m68k_setpc (m68k_getpc ());
+	}
+
+	MemorySnapShot_Store(&regs, sizeof(regs));
+	MemorySnapShot_Store(&regflags, sizeof(regflags));
+	MemorySnapShot_Store(mmufixup, sizeof(mmufixup));
+	MemorySnapShot_Store(icaches030, sizeof(icaches030));
+	MemorySnapShot_Store(dcaches030, sizeof(dcaches030));
+
+	if (!bSave) {
+		regs.spcflags = (regs.spcflags & ~(SPCFLAG_MODE_CHANGE | SPCFLAG_BRK)) | spcflags;
+		m68k_setpc (regs.pc);
+	}
+}
+
 void REGPARAM2 op_unimpl (uae_u16 opcode)
 {
     static int warned;
@@ -1207,6 +1234,21 @@ void doint (void)
 
 #define IDLETIME (currprefs.cpu_idle * sleep_resolution / 700)
 
+/*
+ * Previous: skip idle time. While the CPU is stopped or spinning in an idle
+ * loop, nothing can happen until the next scheduled event, so advance the
+ * cycle counter straight to it. Not done while an interrupt is pending or
+ * the DSP runs on this thread, as it needs the cycles.
+ */
+static void m68k_idle (void)
+{
+	if (!ConfigureParams.System.bIdleSkip || dsp_core.running)
+		return;
+	if (CycInt_InterruptDue() || intlev() > regs.intmask)
+		return;
+	CycInt_SkipIdleTime();
+}
+
 /*
  * Handle special flags
  */
@@ -1226,11 +1268,12 @@ static int do_specialties (int cycles)
             if (regs.spcflags & SPCFLAG_BRK)
                 return 1;
         
+            m68k_idle();
             M68000_AddCycles(cpu_cycles);
 
             /* It is possible one or more ints happen at the same time */
             /* We must process them during the same cpu cycle until the special INT flag is set */
-            while (PendingInterrupt.time <=0 && PendingInterrupt.pFunction) {
+            while (CycInt_InterruptDue()) {
                 /* 1st, we call the interrupt handler */
                 CALL_VAR(PendingInterrupt.pFunction);
                 
@@ -1256,6 +1299,11 @@ static int do_specialties (int cycles)
                     }
                 }
             }
+
+            /* Previous: an interrupt above the mask ends the STOP state */
+            int intr = intlev ();
+            if (intr > regs.intmask)
+                do_interrupt (intr, false);
         }
 	}
 
@@ -1314,6 +1362,8 @@ retry:
 			int cnt;
 insretry:
 			pc = regs.instruction_pc = m68k_getpc ();
+			if (nIdleLoopPCs && M68000_IsIdleLoop(pc))
+				m68k_idle ();
 			f.cznv = regflags.cznv;
 			f.x    = regflags.x;
             
@@ -1358,19 +1408,20 @@ insretry:
 			/* We must check for pending interrupt and call do_specialties_interrupt() only */
 			/* if the cpu is not in the STOP state. Else, the int could be acknowledged now */
 			/* and prevent exiting the STOP state when calling do_specialties() after. */
-			/* For performance, we first test PendingInterruptCount, then regs.spcflags */
-			while ( ( PendingInterrupt.time <= 0 ) && ( PendingInterrupt.pFunction ) && ( ( regs.spcflags & SPCFLAG_STOP ) == 0 ) ) {
+			/* For performance, we first test PendingInterrupt, then regs.spcflags */
+			while ( CycInt_InterruptDue() && ( ( regs.spcflags & SPCFLAG_STOP ) == 0 ) ) {
 				CALL_VAR(PendingInterrupt.pFunction);		/* call the interrupt handler */
 			}
 
-            /* Previous: for now we poll the interrupt pins with every instruction.
-             * TODO: only do this when an actual interrupt is active to not
-             * unneccessarily slow down emulation.
+            /* Previous: the interrupt level is cached by sysReg.c and only
+             * changes when the interrupt status or mask registers change.
              */
             intr = intlev ();
-            if (intr>regs.intmask || (intr==7 && intr>lastintr))
-                do_interrupt (intr, false);
-            lastintr = intr;
+            if (intr|lastintr) {
+                if (intr>regs.intmask || (intr==7 && intr>lastintr))
+                    do_interrupt (intr, false);
+                lastintr = intr;
+            }
             
             if (regs.spcflags & ~SPCFLAG_INT) {
 				if (do_specialties (cpu_cycles))
@@ -1423,6 +1474,8 @@ static void m68k_run_mmu040 (void)
 			f.x = regflags.x;
 			mmu_restart = true;
 			pc = regs.instruction_pc = m68k_getpc ();
+			if (nIdleLoopPCs && M68000_IsIdleLoop(pc))
+				m68k_idle ();
         
             Uint64 beforeCycles = nCyclesMainCounter;
 			mmu_opcode = -1;
@@ -1437,19 +1490,20 @@ static void m68k_run_mmu040 (void)
 			/* We must check for pending interrupt and call do_specialties_interrupt() only */
 			/* if the cpu is not in the STOP state. Else, the int could be acknowledged now */
 			/* and prevent exiting the STOP state when calling do_specialties() after. */
-			/* For performance, we first test PendingInterruptCount, then regs.spcflags */
-			while ( ( PendingInterrupt.time <= 0 ) && ( PendingInterrupt.pFunction ) && ( ( regs.spcflags & SPCFLAG_STOP ) == 0 ) ) {
+			/* For performance, we first test PendingInterrupt, then regs.spcflags */
+			while ( CycInt_InterruptDue() && ( ( regs.spcflags & SPCFLAG_STOP ) == 0 ) ) {
 				CALL_VAR(PendingInterrupt.pFunction);		/* call the interrupt handler */
 			}
 
-            /* Previous: for now we poll the interrupt pins with every instruction.
-             * TODO: only do this when an actual interrupt is active to not
-             * unneccessarily slow down emulation.
+            /* Previous: the interrupt level is cached by sysReg.c and only
+             * changes when the interrupt status or mask registers change.
              */
             intr = intlev ();
-            if (intr>regs.intmask || (intr==7 && intr>lastintr))
-                do_interrupt (intr, false);
-            lastintr = intr;
+            if (intr|lastintr) {
+                if (intr>regs.intmask || (intr==7 && intr>lastintr))
+                    do_interrupt (intr, false);
+                lastintr = intr;
+            }
                         
 			if (regs.spcflags & ~SPCFLAG_INT) {
 				if (do_specialties (cpu_cycles))
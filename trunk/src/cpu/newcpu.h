@@ -712,6 +712,7 @@ extern void exception3i (uae_u32 opcode, uaecptr addr);
 extern void exception3b (uae_u32 opcode, uaecptr addr, bool w, bool i, uaecptr pc);
 extern void exception2 (uaecptr addr, bool read, int size, uae_u32 fc);
 extern void m68k_reset (int hardreset);
+extern void m68k_MemorySnapShot_Capture (bool bSave);
 extern void cpureset (void);
 extern void cpu_halt (int id);
 extern int cpu_sleep_millis(int ms);
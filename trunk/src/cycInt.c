@@ -5,12 +5,12 @@
   your option any later version. Read the file gpl.txt for details.
 
   This code handles our table with callbacks for cycle accurate program
-  interruption. We add any pending callback handler into a table so that we do
-  not need to test for every possible interrupt event. We then scan
-  the list if used entries in the table and copy the one with the least cycle
-  count into the global 'PendingInterrupt' variable. This is then
-  decremented by the execution loop - rather than decrement each and every
-  entry (as the others cannot occur before this one).
+  interruption. We add any pending callback handler into a priority queue so
+  that we do not need to test for every possible interrupt event. The one with
+  the least absolute cycle count is copied into the global 'PendingInterrupt'
+  variable. This is then compared against nCyclesMainCounter by the execution
+  loop - rather than decrement each and every entry (as the others cannot
+  occur before this one).
   We support three time units: CPU cycles, ticks, and microseconds.
   Ticks are bound to CPU cycles and run at TICK_RATE MHz. Microseconds are either
   bound to the host CPU's performance counter in real-time mode or to the emulated
@@ -38,12 +38,10 @@ const char CycInt_fileid[] = "Previous cycInt.c : " __DATE__ " " __TIME__;
 #include "configuration.h"
 #include "main.h"
 #include "nd_sdl.hpp"
+#include "memorySnapShot.h"
 
-void (*PendingInterruptFunction)(void);
-Sint64 PendingInterruptCounter;
 int    usCheckCycles;
 
-Sint64 nCyclesOver;
 Sint64 nCyclesMainCounter;         /* Main cycles counter, counts emulated CPU cycles sind reset */
 
 
@@ -75,8 +73,104 @@ static INTERRUPTHANDLER InterruptHandlers[MAX_INTERRUPTS];
 INTERRUPTHANDLER        PendingInterrupt;
 static int              ActiveInterrupt=0;
 
+/* Pending handlers are kept in two binary min-heaps, one for CPU cycle and
+ * one for microsecond timeouts. Both store absolute times, so nothing needs
+ * to be adjusted when cycles pass. The heaps hold interrupt ids, the time
+ * is taken from InterruptHandlers[]. */
+enum {
+    HEAP_CPU,
+    HEAP_US,
+    NUM_HEAPS
+};
+
+static interrupt_id IntHeap[NUM_HEAPS][MAX_INTERRUPTS];
+static int          IntHeapSize[NUM_HEAPS];
+static int          IntHeapPos[MAX_INTERRUPTS];    /* position of handler in its heap */
+
 static void CycInt_SetNewInterrupt(void);
 
+static inline int CycInt_HeapOf(int type) {
+    return type == CYC_INT_US ? HEAP_US : HEAP_CPU;
+}
+
+static inline void CycInt_HeapSet(int h, int pos, interrupt_id id) {
+    IntHeap[h][pos] = id;
+    IntHeapPos[id]  = pos;
+}
+
+static void CycInt_HeapUp(int h, int pos) {
+    interrupt_id id   = IntHeap[h][pos];
+    Sint64       time = InterruptHandlers[id].time;
+    
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (InterruptHandlers[IntHeap[h][parent]].time <= time)
+            break;
+        CycInt_HeapSet(h, pos, IntHeap[h][parent]);
+        pos = parent;
+    }
+    CycInt_HeapSet(h, pos, id);
+}
+
+static void CycInt_HeapDown(int h, int pos) {
+    interrupt_id id   = IntHeap[h][pos];
+    Sint64       time = InterruptHandlers[id].time;
+    int          size = IntHeapSize[h];
+    
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && InterruptHandlers[IntHeap[h][child+1]].time < InterruptHandlers[IntHeap[h][child]].time)
+            child++;
+        if (time <= InterruptHandlers[IntHeap[h][child]].time)
+            break;
+        CycInt_HeapSet(h, pos, IntHeap[h][child]);
+        pos = child;
+    }
+    CycInt_HeapSet(h, pos, id);
+}
+
+/**
+ * Remove handler from its heap and mark it inactive.
+ */
+static void CycInt_HeapRemove(interrupt_id Handler) {
+    int h, pos, last;
+    
+    if (InterruptHandlers[Handler].type == CYC_INT_NONE)
+        return;
+    
+    h    = CycInt_HeapOf(InterruptHandlers[Handler].type);
+    pos  = IntHeapPos[Handler];
+    last = --IntHeapSize[h];
+    
+    if (pos != last) {
+        /* Move last entry into the gap and restore heap order */
+        interrupt_id moved = IntHeap[h][last];
+        CycInt_HeapSet(h, pos, moved);
+        CycInt_HeapDown(h, pos);
+        CycInt_HeapUp(h, IntHeapPos[moved]);
+    }
+    InterruptHandlers[Handler].type = CYC_INT_NONE;
+    InterruptHandlers[Handler].time = INT64_MAX;
+}
+
+/**
+ * (Re-)schedule handler at an absolute time. An already pending instance
+ * of the same handler is replaced.
+ */
+static void CycInt_HeapInsert(interrupt_id Handler, int type, Sint64 time) {
+    int h = CycInt_HeapOf(type);
+    
+    CycInt_HeapRemove(Handler);
+    
+    InterruptHandlers[Handler].type = type;
+    InterruptHandlers[Handler].time = time;
+    
+    CycInt_HeapSet(h, IntHeapSize[h]++, Handler);
+    CycInt_HeapUp(h, IntHeapPos[Handler]);
+}
+
 /*-----------------------------------------------------------------------*/
 /**
  * Reset interrupts, handlers
@@ -85,9 +179,10 @@ void CycInt_Reset(void) {
 	int i;
 
 	/* Reset counts */
-    PendingInterrupt.time = 0;
+    PendingInterrupt.type      = CYC_INT_NONE;
+    PendingInterrupt.time      = INT64_MAX;
+    PendingInterrupt.pFunction = NULL;
 	ActiveInterrupt       = 0;
-	nCyclesOver           = 0;
     nCyclesMainCounter    = 0;
     usCheckCycles         = 0;
         
@@ -97,26 +192,60 @@ void CycInt_Reset(void) {
 		InterruptHandlers[i].time      = INT64_MAX;
 		InterruptHandlers[i].pFunction = pIntHandlerFunctions[i];
 	}
+    for (i=0; i<NUM_HEAPS; i++) {
+        IntHeapSize[i] = 0;
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save and restore snapshot of interrupt variables. Only type and time
+ * of each handler are stored, the heaps are rebuilt on restore.
+ */
+void CycInt_MemorySnapShot_Capture(bool bSave) {
+    int i, type;
+    Sint64 time;
+    
+    MemorySnapShot_Store(&nCyclesMainCounter, sizeof(nCyclesMainCounter));
+    MemorySnapShot_Store(&usCheckCycles, sizeof(usCheckCycles));
+    
+    if (!bSave) {
+        for (i=0; i<NUM_HEAPS; i++) {
+            IntHeapSize[i] = 0;
+        }
+    }
+    
+    for (i=0; i<MAX_INTERRUPTS; i++) {
+        type = InterruptHandlers[i].type;
+        time = InterruptHandlers[i].time;
+        MemorySnapShot_Store(&type, sizeof(type));
+        MemorySnapShot_Store(&time, sizeof(time));
+        
+        if (!bSave) {
+            InterruptHandlers[i].type      = CYC_INT_NONE;
+            InterruptHandlers[i].time      = INT64_MAX;
+            InterruptHandlers[i].pFunction = pIntHandlerFunctions[i];
+            if (type == CYC_INT_CPU || type == CYC_INT_US)
+                CycInt_HeapInsert(i, type, time);
+        }
+    }
+    
+    if (!bSave) {
+        CycInt_SetNewInterrupt();
+    }
 }
 
 /*-----------------------------------------------------------------------*/
 /**
- * Find next interrupt to occur, and store to global variables for decrement
- * in instruction decode loop.
+ * Find next interrupt to occur, and store to global variables for
+ * comparison with nCyclesMainCounter in instruction decode loop.
  * (SC) Microsecond interrupts are skipped here and handled in the decode loop.
  */
 static void CycInt_SetNewInterrupt(void) {
-	Sint64       LowestCycleCount = INT64_MAX;
-	interrupt_id LowestInterrupt  = INTERRUPT_NULL;
+	interrupt_id LowestInterrupt = INTERRUPT_NULL;
     
-	/* Find next interrupt to go off */
-	for(int i = INTERRUPT_NULL+1; i < MAX_INTERRUPTS; i++) {
-        /* Is interrupt pending? */
-        if(InterruptHandlers[i].type == CYC_INT_CPU && InterruptHandlers[i].time < LowestCycleCount) {
-            LowestCycleCount = InterruptHandlers[i].time;
-            LowestInterrupt  = i;
-        }
-	}
+    if (IntHeapSize[HEAP_CPU] > 0)
+        LowestInterrupt = IntHeap[HEAP_CPU][0];
 
 	/* Set new counts, active interrupt */
     PendingInterrupt = InterruptHandlers[LowestInterrupt];
@@ -125,49 +254,66 @@ static void CycInt_SetNewInterrupt(void) {
 
 /*-----------------------------------------------------------------------*/
 /**
- * Adjust all interrupt timings, MUST call CycInt_SetNewInterrupt after this.
+ * Check microsecond interrupt timings. Only the earliest one needs
+ * to be compared against the host clock.
  */
-static void CycInt_UpdateInterrupt(void) {
-	int i;
-
-	/* Adjust table by subtracting cycles that have passed since last update */
-	for (i = 0; i < MAX_INTERRUPTS; i++) {
-		if (InterruptHandlers[i].type == CYC_INT_CPU)
-			InterruptHandlers[i].time -= nCyclesOver;
-	}
-    nCyclesOver = 0;
+bool CycInt_SetNewInterruptUs(void) {
+    if (IntHeapSize[HEAP_US] > 0) {
+        interrupt_id i = IntHeap[HEAP_US][0];
+        if ((Sint64)host_time_us() > InterruptHandlers[i].time) {
+            PendingInterrupt      = InterruptHandlers[i];
+            PendingInterrupt.time = -1;
+            ActiveInterrupt       = i;
+            return true;
+        }
+    }
+    return false;
 }
 
 /*-----------------------------------------------------------------------*/
 /**
- * Check all microsecond interrupt timings
+ * Advance the cycle counter to the next scheduled interrupt. Only call this
+ * while the CPU is idle (STOP or an idle loop), so nothing but the pending
+ * interrupts can change the machine state in the meantime. If the next event
+ * is a microsecond interrupt and the host clock is in real-time mode, sleep
+ * until it is due instead of burning host CPU time.
  */
-bool CycInt_SetNewInterruptUs(void) {
-    Sint64 now = host_time_us();
-    if (ConfigureParams.System.bRealtime) {
-        for(int i = 0; i < MAX_INTERRUPTS; i++) {
-            if (InterruptHandlers[i].type == CYC_INT_US && now > InterruptHandlers[i].time) {
-                PendingInterrupt = InterruptHandlers[i];
-                PendingInterrupt.time = -1;
-                ActiveInterrupt       = i;
-                return true;
-            }
-        }
+void CycInt_SkipIdleTime(void) {
+    Sint64 cycles = INT64_MAX;
+    Sint64 us     = 0;
+    
+    if (IntHeapSize[HEAP_CPU] > 0)
+        cycles = InterruptHandlers[IntHeap[HEAP_CPU][0]].time - nCyclesMainCounter;
+    
+    if (IntHeapSize[HEAP_US] > 0) {
+        Sint64 usCycles;
+        us = InterruptHandlers[IntHeap[HEAP_US][0]].time + 1 - (Sint64)host_time_us();
+        if (us < 0)
+            us = 0;
+        usCycles = us * ConfigureParams.System.nCpuFreq;
+        if (usCycles < cycles)
+            cycles = usCycles;
+        else
+            us = 0;
     }
-    return false;
+    
+    if (cycles <= 0 || cycles == INT64_MAX)
+        return;
+    
+    if (us > 0 && host_is_realtime())
+        host_sleep_us(us);
+    
+    nCyclesMainCounter += cycles;
+    usCheckCycles       = -1;
 }
 
 /*-----------------------------------------------------------------------*/
 /**
- * Adjust all interrupt timings as 'ActiveInterrupt' has occured, and
- * remove from active list.
+ * Remove 'ActiveInterrupt' from active list as it has occured.
  */
 void CycInt_AcknowledgeInterrupt(void) {
-	/* Update list cycle counts */
-	CycInt_UpdateInterrupt();
-
 	/* Disable interrupt entry which has just occured */
-	InterruptHandlers[ActiveInterrupt].type = CYC_INT_NONE;
+	CycInt_HeapRemove(ActiveInterrupt);
 
 	/* Set new */
 	CycInt_SetNewInterrupt();
@@ -180,15 +326,9 @@ void CycInt_AcknowledgeInterrupt(void) {
 void CycInt_AddRelativeInterruptCycles(Sint64 CycleTime, interrupt_id Handler) {
 	assert(CycleTime >= 0);
 
-	/* Update list cycle counts with current PendingInterruptCount before adding a new int, */
-	/* because CycInt_SetNewInterrupt can change the active int / PendingInterruptCount */
-	if ( ActiveInterrupt > 0 )
-		CycInt_UpdateInterrupt();
-
-	InterruptHandlers[Handler].type = CYC_INT_CPU;
-	InterruptHandlers[Handler].time = CycleTime;
+	CycInt_HeapInsert(Handler, CYC_INT_CPU, nCyclesMainCounter + CycleTime);
 
-	/* Set new active int and compute a new value for PendingInterruptCount*/
+	/* Set new active int */
 	CycInt_SetNewInterrupt();
 }
 
@@ -201,16 +341,11 @@ void CycInt_AddRelativeInterruptUs(Sint64 us, Sint64 usreal, interrupt_id Handle
     assert(us >= 0);
     
     if(ConfigureParams.System.bRealtime) {
-        /* Update list cycle counts with current PendingInterruptCount before adding a new int, */
-        /* because CycInt_SetNewInterrupt can change the active int / PendingInterruptCount */
-        if ( ActiveInterrupt > 0 ) CycInt_UpdateInterrupt();
-        
         if ( usreal > 0 ) us = usreal;
         
-        InterruptHandlers[Handler].type = CYC_INT_US;
-        InterruptHandlers[Handler].time = host_time_us() + us;
+        CycInt_HeapInsert(Handler, CYC_INT_US, host_time_us() + us);
         
-        /* Set new active int and compute a new value for PendingInterruptCount*/
+        /* Set new active int */
         CycInt_SetNewInterrupt();
     } else {
         CycInt_AddRelativeInterruptCycles(us * ConfigureParams.System.nCpuFreq, Handler);
@@ -236,12 +371,8 @@ void CycInt_AddRelativeInterruptUsCycles(Sint64 us, Sint64 usreal, interrupt_id
  * Remove a pending interrupt from our table
  */
 void CycInt_RemovePendingInterrupt(interrupt_id Handler) {
-	/* Update list cycle counts, including the handler we want to remove */
-	/* to be able to resume it later */
-	CycInt_UpdateInterrupt();
-
-	/* Stop interrupt after CycInt_UpdateInterrupt */
-	InterruptHandlers[Handler].type = CYC_INT_NONE;
+	/* Stop interrupt */
+	CycInt_HeapRemove(Handler);
 
 	/* Set new */
 	CycInt_SetNewInterrupt();
@@ -21,6 +21,7 @@ const char DebugInfo_fileid[] = "Hatari debuginfo.c : " __DATE__ " " __TIME__;
 #include "file.h"
 #include "ioMem.h"
 #include "m68000.h"
+#include "scsi.h"
 #include "screen.h"
 #include "video.h"
 
@@ -38,6 +39,22 @@ static void DebugInfo_Rtc(Uint32 dummy) {
 	fprintf(stdout,"%s",get_rtc_ram_info());
 }
 
+/**
+ * DebugInfo_Scsi : display the SCSI disk access statistics.
+ */
+static void DebugInfo_Scsi(Uint32 dummy) {
+	SCSI_STATS stats;
+	int i;
+
+	fprintf(stdout, "Target   Commands        Bytes   Syscalls Cache hits\n");
+	for (i = 0; i < ESP_MAX_DEVS; i++) {
+		SCSI_GetStats(i, &stats);
+		fprintf(stdout, "%6d %10llu %12llu %10llu %10llu\n", i,
+		        (unsigned long long)stats.commands, (unsigned long long)stats.bytes,
+		        (unsigned long long)stats.syscalls, (unsigned long long)stats.cache_hits);
+	}
+}
+
 /* ------------------------------------------------------------------
  * CPU and DSP information wrappers
  */
@@ -219,7 +236,8 @@ static const struct {
 	{ true, "memdump",   DebugInfo_CpuMemDump, NULL, "Dump CPU memory from given <address>" },
 	{ true, "regaddr",   DebugInfo_RegAddr, DebugInfo_RegAddrArgs, "Show <disasm|memdump> from CPU/DSP address pointed by <register>" },
 	{ true, "registers", DebugInfo_CpuRegister,NULL, "Show CPU registers values" },
-	{ false,"rtc",     DebugInfo_Rtc,      NULL, "Show Next's RTC registers" }
+	{ false,"rtc",     DebugInfo_Rtc,      NULL, "Show Next's RTC registers" },
+	{ false,"scsi",    DebugInfo_Scsi,     NULL, "Show SCSI disk access statistics" }
 };
 
 static int LockedFunction = 4; /* index for the "default" function */
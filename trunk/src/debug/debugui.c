@@ -28,6 +28,7 @@ const char DebugUI_fileid[] = "Hatari debugui.c : " __DATE__ " " __TIME__;
 #include "log.h"
 #include "m68000.h"
 #include "screen.h"
+#include "scsi.h"
 #include "statusbar.h"
 #include "str.h"
 
@@ -366,6 +367,42 @@ static int DebugUI_ChangeDir(int argc, char *argv[])
 }
 
 
+/**
+ * Command: Commit, discard or stack SCSI disk overlays
+ */
+static int DebugUI_Overlay(int argc, char *argv[])
+{
+	int target;
+	bool ok;
+
+	if (argc >= 3)
+	{
+		target = atoi(argv[1]);
+		if (target < 0 || target >= ESP_MAX_DEVS)
+		{
+			fprintf(stderr, "ERROR: invalid SCSI target '%s'!\n", argv[1]);
+			return DEBUGGER_CMDDONE;
+		}
+		if (argc == 3 && strcmp(argv[2], "commit") == 0)
+			ok = SCSI_OverlayCommit(target);
+		else if (argc == 3 && strcmp(argv[2], "discard") == 0)
+			ok = SCSI_OverlayDiscard(target);
+		else if (argc == 4 && strcmp(argv[2], "push") == 0)
+			ok = SCSI_OverlayPush(target, argv[3]);
+		else
+		{
+			DebugUI_PrintCmdHelp(argv[0]);
+			return DEBUGGER_CMDDONE;
+		}
+		if (!ok)
+			fprintf(stderr, "ERROR: overlay %s failed for SCSI target %d!\n", argv[2], target);
+		return DEBUGGER_CMDDONE;
+	}
+	DebugUI_PrintCmdHelp(argv[0]);
+	return DEBUGGER_CMDDONE;
+}
+
+
 /**
  * Command: Read debugger commands from a file
  */
@@ -773,6 +810,14 @@ static const dbgcommand_t uicommand[] =
 	  "\tOpen log file, no argument closes the log file. Output of\n"
 	  "\tregister & memory dumps and disassembly will be written to it.",
 	  false },
+	{ DebugUI_Overlay, NULL,
+	  "overlay", "",
+	  "commit, discard or stack SCSI disk overlays",
+	  "<target> <commit|discard|push <filename>>\n"
+	  "\tCommit the overlay of a SCSI disk to its parent or disk image,\n"
+	  "\tdiscard the blocks written to it, or keep it as a snapshot and\n"
+	  "\tcontinue with a new overlay file on top of it.",
+	  false },
 	{ DebugUI_CommandsFromFile, NULL,
 	  "parse", "p",
 	  "get debugger commands from file",
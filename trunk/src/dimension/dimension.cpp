@@ -6,9 +6,11 @@
 #include "nd_nbic.hpp"
 #include "nd_mem.hpp"
 #include "nd_sdl.hpp"
+#include "memorySnapShot.h"
 
 #define nd_get_mem_bank(addr)    (nd->mem_banks[nd_bankindex(addr|ND_BOARD_BITS)])
 #define nd68k_get_mem_bank(addr) (mem_banks[nd_bankindex(addr)])
+#define nd_get_mem_host(addr)    (nd->mem_host[nd_bankindex(addr|ND_BOARD_BITS)])
 
 #define nd_longget(addr)   (nd_get_mem_bank(addr)->lget(addr))
 #define nd_wordget(addr)   (nd_get_mem_bank(addr)->wget(addr))
@@ -29,6 +31,7 @@
 NextDimension::NextDimension(int slot) :
     NextBusBoard(slot),
     mem_banks(new ND_Addrbank*[65536]),
+    mem_host(new Uint8*[65536]),
     ram(host_malloc_aligned(64*1024*1024)),
     vram(host_malloc_aligned(4*1024*1024)),
     rom(host_malloc_aligned(128*1024)),
@@ -58,6 +61,7 @@ NextDimension::~NextDimension() {
     sdl.destroy();
     
     delete[] mem_banks;
+    delete[] mem_host;
     free(ram);
     free(vram);
     free(rom);
@@ -74,6 +78,68 @@ void NextDimension::pause(bool pause) {
     sdl.pause(pause);
 }
 
+/* Save/restore board state. MC, DP and the video devices hold a pointer
+ * to the board, so only their register fields are stored. */
+void NextDimension::snapshot(bool bSave) {
+    MemorySnapShot_StorePages(ram, 64*1024*1024);
+    MemorySnapShot_StorePages(vram, 4*1024*1024);
+    if (!bSave) sdl.set_dirty();
+    MemorySnapShot_Store(rom, 128*1024);
+    MemorySnapShot_Store(dmem, sizeof(dmem));
+    MemorySnapShot_Store(&rom_command, sizeof(rom_command));
+    MemorySnapShot_Store(&rom_last_addr, sizeof(rom_last_addr));
+    
+    MemorySnapShot_Store(&mc.csr0, sizeof(mc.csr0));
+    MemorySnapShot_Store(&mc.csr1, sizeof(mc.csr1));
+    MemorySnapShot_Store(&mc.csr2, sizeof(mc.csr2));
+    MemorySnapShot_Store(&mc.sid, sizeof(mc.sid));
+    MemorySnapShot_Store(&mc.dma_csr, sizeof(mc.dma_csr));
+    MemorySnapShot_Store(&mc.dma_start, sizeof(mc.dma_start));
+    MemorySnapShot_Store(&mc.dma_width, sizeof(mc.dma_width));
+    MemorySnapShot_Store(&mc.dma_pstart, sizeof(mc.dma_pstart));
+    MemorySnapShot_Store(&mc.dma_pwidth, sizeof(mc.dma_pwidth));
+    MemorySnapShot_Store(&mc.dma_sstart, sizeof(mc.dma_sstart));
+    MemorySnapShot_Store(&mc.dma_swidth, sizeof(mc.dma_swidth));
+    MemorySnapShot_Store(&mc.dma_bsstart, sizeof(mc.dma_bsstart));
+    MemorySnapShot_Store(&mc.dma_bswidth, sizeof(mc.dma_bswidth));
+    MemorySnapShot_Store(&mc.dma_top, sizeof(mc.dma_top));
+    MemorySnapShot_Store(&mc.dma_bottom, sizeof(mc.dma_bottom));
+    MemorySnapShot_Store(&mc.dma_line_a, sizeof(mc.dma_line_a));
+    MemorySnapShot_Store(&mc.dma_curr_a, sizeof(mc.dma_curr_a));
+    MemorySnapShot_Store(&mc.dma_scurr_a, sizeof(mc.dma_scurr_a));
+    MemorySnapShot_Store(&mc.dma_out_a, sizeof(mc.dma_out_a));
+    MemorySnapShot_Store(&mc.vram, sizeof(mc.vram));
+    MemorySnapShot_Store(&mc.dram, sizeof(mc.dram));
+    
+    MemorySnapShot_Store(&dp.iic_addr, sizeof(dp.iic_addr));
+    MemorySnapShot_Store(&dp.iic_msg, sizeof(dp.iic_msg));
+    MemorySnapShot_Store(&dp.iic_msgsz, sizeof(dp.iic_msgsz));
+    MemorySnapShot_Store(&dp.iic_busy, sizeof(dp.iic_busy));
+    MemorySnapShot_Store(&dp.doff, sizeof(dp.doff));
+    MemorySnapShot_Store(&dp.csr, sizeof(dp.csr));
+    MemorySnapShot_Store(&dp.alpha, sizeof(dp.alpha));
+    MemorySnapShot_Store(&dp.dma, sizeof(dp.dma));
+    MemorySnapShot_Store(&dp.cpu_x, sizeof(dp.cpu_x));
+    MemorySnapShot_Store(&dp.cpu_y, sizeof(dp.cpu_y));
+    MemorySnapShot_Store(&dp.dma_x, sizeof(dp.dma_x));
+    MemorySnapShot_Store(&dp.dma_y, sizeof(dp.dma_y));
+    MemorySnapShot_Store(&dp.iic_stat_addr, sizeof(dp.iic_stat_addr));
+    MemorySnapShot_Store(&dp.iic_data, sizeof(dp.iic_data));
+    
+    MemorySnapShot_Store(&dmcd.addr, sizeof(dmcd.addr));
+    MemorySnapShot_Store(dmcd.reg, sizeof(dmcd.reg));
+    MemorySnapShot_Store(&dcsc0.addr, sizeof(dcsc0.addr));
+    MemorySnapShot_Store(&dcsc0.ctrl, sizeof(dcsc0.ctrl));
+    MemorySnapShot_Store(dcsc0.lut, sizeof(dcsc0.lut));
+    MemorySnapShot_Store(&dcsc1.addr, sizeof(dcsc1.addr));
+    MemorySnapShot_Store(&dcsc1.ctrl, sizeof(dcsc1.ctrl));
+    MemorySnapShot_Store(dcsc1.lut, sizeof(dcsc1.lut));
+    MemorySnapShot_Store(&ramdac, sizeof(ramdac));
+    
+    nbic.snapshot(bSave);
+    i860.snapshot(bSave);
+}
+
 /* NeXTdimension board memory access (m68k) */
 
  Uint32 NextDimension::board_lget(Uint32 addr) {
@@ -172,33 +238,59 @@ void NextDimension::send_msg(int msg) {
     do {
         value = m_port.value;
     } while (!host_atomic_cas(&m_port, value, (value | msg)));
+    i860.wake();
 }
 
-/* NeXTdimension board memory access (i860) */
+bool NextDimension::has_msgs(void) {
+    return host_atomic_get(&m_port) != 0;
+}
+
+/* NeXTdimension board memory access (i860)
+ * Plain memory banks are accessed through their host pointer, all other
+ * banks through their access functions. */
+
+#define ND_HOST(addr) (host + ((addr) & ND_BANK_OFFSET_MASK))
 
 Uint8  NextDimension::i860_cs8get(const NextDimension* nd, Uint32 addr) {
     return nd_cs8get(addr);
 }
 
 void   NextDimension::i860_rd8_be(const NextDimension* nd, Uint32 addr, Uint32* val) {
-    *((Uint8*)val) = nd_byteget(addr);
+    const Uint8* host = nd_get_mem_host(addr);
+    *((Uint8*)val) = host ? *ND_HOST(addr) : nd_byteget(addr);
 }
 
 void   NextDimension::i860_rd16_be(const NextDimension* nd, Uint32 addr, Uint32* val) {
-    *((Uint16*)val) = nd_wordget(addr);
+    const Uint8* host = nd_get_mem_host(addr);
+    *((Uint16*)val) = host ? do_get_mem_word(ND_HOST(addr)) : nd_wordget(addr);
 }
 
 void   NextDimension::i860_rd32_be(const NextDimension* nd, Uint32 addr, Uint32* val) {
-    val[0] = nd_longget(addr);
+    const Uint8* host = nd_get_mem_host(addr);
+    val[0] = host ? do_get_mem_long(ND_HOST(addr)) : nd_longget(addr);
 }
 
 void   NextDimension::i860_rd64_be(const NextDimension* nd, Uint32 addr, Uint32* val) {
+    const Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        val[0] = do_get_mem_long(ND_HOST(addr+4));
+        val[1] = do_get_mem_long(ND_HOST(addr+0));
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     val[0] = ab->lget(addr+4);
     val[1] = ab->lget(addr+0);
 }
 
 void   NextDimension::i860_rd128_be(const NextDimension* nd, Uint32 addr, Uint32* val) {
+    const Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        val[0]  = do_get_mem_long(ND_HOST(addr+4));
+        val[1]  = do_get_mem_long(ND_HOST(addr+0));
+        val[2]  = do_get_mem_long(ND_HOST(addr+12));
+        val[3]  = do_get_mem_long(ND_HOST(addr+8));
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     val[0]  = ab->lget(addr+4);
     val[1]  = ab->lget(addr+0);
@@ -207,24 +299,44 @@ void   NextDimension::i860_rd128_be(const NextDimension* nd, Uint32 addr, Uint32
 }
 
 void   NextDimension::i860_wr8_be(const NextDimension* nd, Uint32 addr, const Uint32* val) {
-    nd_byteput(addr, *((const Uint8*)val));
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) *ND_HOST(addr) = *((const Uint8*)val);
+    else     nd_byteput(addr, *((const Uint8*)val));
 }
 
 void   NextDimension::i860_wr16_be(const NextDimension* nd, Uint32 addr, const Uint32* val) {
-    nd_wordput(addr, *((const Uint16*)val));
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) do_put_mem_word(ND_HOST(addr), *((const Uint16*)val));
+    else     nd_wordput(addr, *((const Uint16*)val));
 }
 
 void   NextDimension::i860_wr32_be(const NextDimension* nd, Uint32 addr, const Uint32* val) {
-    nd_longput(addr, val[0]);
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) do_put_mem_long(ND_HOST(addr), val[0]);
+    else     nd_longput(addr, val[0]);
 }
 
 void   NextDimension::i860_wr64_be(const NextDimension* nd, Uint32 addr, const Uint32* val) {
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        do_put_mem_long(ND_HOST(addr+4), val[0]);
+        do_put_mem_long(ND_HOST(addr+0), val[1]);
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     ab->lput(addr+4, val[0]);
     ab->lput(addr+0, val[1]);
 }
 
 void   NextDimension::i860_wr128_be(const NextDimension* nd, Uint32 addr, const Uint32* val) {
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        do_put_mem_long(ND_HOST(addr+4),  val[0]);
+        do_put_mem_long(ND_HOST(addr+0),  val[1]);
+        do_put_mem_long(ND_HOST(addr+12), val[2]);
+        do_put_mem_long(ND_HOST(addr+8),  val[3]);
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     ab->lput(addr+4,  val[0]);
     ab->lput(addr+0,  val[1]);
@@ -233,24 +345,41 @@ void   NextDimension::i860_wr128_be(const NextDimension* nd, Uint32 addr, const
 }
 
 void   NextDimension::i860_rd8_le(const NextDimension* nd, Uint32 addr, Uint32* val) {
-    *((Uint8*)val) = nd_byteget(addr^7);
+    const Uint8* host = nd_get_mem_host(addr);
+    *((Uint8*)val) = host ? *ND_HOST(addr^7) : nd_byteget(addr^7);
 }
 
 void   NextDimension::i860_rd16_le(const NextDimension* nd, Uint32 addr, Uint32* val) {
-    *((Uint16*)val) = nd_wordget(addr^6);
+    const Uint8* host = nd_get_mem_host(addr);
+    *((Uint16*)val) = host ? do_get_mem_word(ND_HOST(addr^6)) : nd_wordget(addr^6);
 }
 
 void   NextDimension::i860_rd32_le(const NextDimension* nd, Uint32 addr, Uint32* val) {
-    val[0] = nd_longget(addr^4);
+    const Uint8* host = nd_get_mem_host(addr);
+    val[0] = host ? do_get_mem_long(ND_HOST(addr^4)) : nd_longget(addr^4);
 }
 
 void   NextDimension::i860_rd64_le(const NextDimension* nd, Uint32 addr, Uint32* val) {
+    const Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        val[0] = do_get_mem_long(ND_HOST(addr+0));
+        val[1] = do_get_mem_long(ND_HOST(addr+4));
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     val[0] = ab->lget(addr+0);
     val[1] = ab->lget(addr+4);
 }
 
 void   NextDimension::i860_rd128_le(const NextDimension* nd, Uint32 addr, Uint32* val) {
+    const Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        val[0]  = do_get_mem_long(ND_HOST(addr+0));
+        val[1]  = do_get_mem_long(ND_HOST(addr+4));
+        val[2]  = do_get_mem_long(ND_HOST(addr+8));
+        val[3]  = do_get_mem_long(ND_HOST(addr+12));
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     val[0]  = ab->lget(addr+0);
     val[1]  = ab->lget(addr+4);
@@ -259,24 +388,44 @@ void   NextDimension::i860_rd128_le(const NextDimension* nd, Uint32 addr, Uint32
 }
 
 void   NextDimension::i860_wr8_le(const NextDimension* nd, Uint32 addr, const Uint32* val) {
-    nd_byteput(addr^7, *((const Uint8*)val));
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) *ND_HOST(addr^7) = *((const Uint8*)val);
+    else     nd_byteput(addr^7, *((const Uint8*)val));
 }
 
 void   NextDimension::i860_wr16_le(const NextDimension* nd, Uint32 addr, const Uint32* val) {
-    nd_wordput(addr^6, *((const Uint16*)val));
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) do_put_mem_word(ND_HOST(addr^6), *((const Uint16*)val));
+    else     nd_wordput(addr^6, *((const Uint16*)val));
 }
 
 void   NextDimension::i860_wr32_le(const NextDimension* nd, Uint32 addr, const Uint32* val) {
-    nd_longput(addr^4, val[0]);
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) do_put_mem_long(ND_HOST(addr^4), val[0]);
+    else     nd_longput(addr^4, val[0]);
 }
 
 void   NextDimension::i860_wr64_le(const NextDimension* nd, Uint32 addr, const Uint32* val) {
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        do_put_mem_long(ND_HOST(addr+0), val[0]);
+        do_put_mem_long(ND_HOST(addr+4), val[1]);
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     ab->lput(addr+0, val[0]);
     ab->lput(addr+4, val[1]);
 }
 
 void   NextDimension::i860_wr128_le(const NextDimension* nd, Uint32 addr, const Uint32* val) {
+    Uint8* host = nd_get_mem_host(addr);
+    if(host) {
+        do_put_mem_long(ND_HOST(addr+0),  val[0]);
+        do_put_mem_long(ND_HOST(addr+4),  val[1]);
+        do_put_mem_long(ND_HOST(addr+8),  val[2]);
+        do_put_mem_long(ND_HOST(addr+12), val[3]);
+        return;
+    }
     const ND_Addrbank* ab = nd_get_mem_bank(addr);
     ab->lput(addr+0,  val[0]);
     ab->lput(addr+4,  val[1]);
@@ -328,6 +477,13 @@ extern "C" {
         else
             return NULL;
     }
+    
+    bool nd_vram_get_dirty(int slot, Uint32* lines) {
+        IF_NEXT_DIMENSION(slot, nd)
+            return nd->sdl.get_dirty(lines);
+        else
+            return false;
+    }
 }
 
 
@@ -21,6 +21,7 @@ extern "C" {
     void nd_start_debugger(void);
     const char* nd_reports(double realTime, double hostTime);
     Uint32* nd_vram_for_slot(int slot);
+    bool    nd_vram_get_dirty(int slot, Uint32* lines);
     
 #define ND_LOG_IO_RD LOG_NONE
 #define ND_LOG_IO_WR LOG_NONE
@@ -125,6 +126,7 @@ class NextDimension : public NextBusBoard {
     atomic_int      m_port;
 public:
     ND_Addrbank**   mem_banks;
+    Uint8**         mem_host;
     Uint8*          ram;
     Uint8*          vram;
     Uint8*          rom;
@@ -166,6 +168,7 @@ public:
 
     virtual void   reset(void);
     virtual void   pause(bool pause);
+    virtual void   snapshot(bool bSave);
 
     static Uint8  i860_cs8get  (const NextDimension* nd, Uint32 addr);
     static void   i860_rd8_be  (const NextDimension* nd, Uint32 addr, Uint32* val);
@@ -194,6 +197,7 @@ public:
     void   rom_load();
         
     bool   handle_msgs(void);  /* i860 thread message handler */
+    bool   has_msgs(void);
     void   send_msg(int msg);
 
     void   set_blank_state(int src, bool state);
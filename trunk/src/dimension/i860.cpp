@@ -24,6 +24,7 @@
 #include "i860.hpp"
 #include "dimension.hpp"
 #include "log.h"
+#include "memorySnapShot.h"
 
 extern "C" {
     static void i860_run_nop(int nHostCycles) {}
@@ -58,6 +59,9 @@ extern "C" {
 i860_cpu_device::i860_cpu_device(NextDimension* nd) : nd(nd) {
     m_thread = NULL;
     m_halt   = true;
+    m_wake   = host_sem_create();
+    host_atomic_set(&m_parked, 0);
+    host_atomic_set(&i860cycles, 0);
     
     sprintf(m_thread_name, "[ND] Slot %d: i860", nd->slot);
     
@@ -76,6 +80,10 @@ i860_cpu_device::i860_cpu_device(NextDimension* nd) : nd(nd) {
     }
 }
 
+i860_cpu_device::~i860_cpu_device() {
+    host_sem_destroy(m_wake);
+}
+
 int i860_cpu_device::thread(void* data) {
     SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW);
     ((i860_cpu_device*)data)->run();
@@ -421,6 +429,10 @@ void i860_cpu_device::init(void) {
                ConfigureParams.Dimension.bI860Thread ? "using seperate thread for i860" : "i860 running on m68k thread. WARNING: expect slow emulation");
     
     reset_fpcs(&m_fpcs);
+#if WITH_HOSTFLOAT_I860
+    m_host_fpu       = ConfigureParams.Dimension.bI860HostFPU;
+    m_host_fpu_check = ConfigureParams.Dimension.bI860HostFPUCheck;
+#endif
     
     m_single_stepping   = 0;
     m_lastcmd           = 0;
@@ -531,10 +543,60 @@ void i860_cpu_device::uninit() {
     }
 }
 
+/* Save/restore i860 state. The i860 thread is stopped while the
+ * registers are accessed and restarted afterwards. */
+void i860_cpu_device::snapshot(bool bSave) {
+    if(m_thread) {
+        nd->send_msg(MSG_I860_KILL);
+        host_thread_wait(m_thread);
+        m_thread = NULL;
+    }
+    
+    MemorySnapShot_Store(&m_pc, sizeof(m_pc));
+    MemorySnapShot_Store(m_iregs, sizeof(m_iregs));
+    MemorySnapShot_Store(m_fregs, sizeof(m_fregs));
+    MemorySnapShot_Store(m_cregs, sizeof(m_cregs));
+    MemorySnapShot_Store(&m_dim, sizeof(m_dim));
+    MemorySnapShot_Store(&m_dim_cc, sizeof(m_dim_cc));
+    MemorySnapShot_Store(&m_dim_cc_valid, sizeof(m_dim_cc_valid));
+    MemorySnapShot_Store(&m_save_dim, sizeof(m_save_dim));
+    MemorySnapShot_Store(&m_save_flow, sizeof(m_save_flow));
+    MemorySnapShot_Store(&m_save_cc, sizeof(m_save_cc));
+    MemorySnapShot_Store(&m_save_cc_valid, sizeof(m_save_cc_valid));
+    MemorySnapShot_Store(&m_KR, sizeof(m_KR));
+    MemorySnapShot_Store(&m_KI, sizeof(m_KI));
+    MemorySnapShot_Store(&m_T, sizeof(m_T));
+    MemorySnapShot_Store(&m_merge, sizeof(m_merge));
+    MemorySnapShot_Store(m_A, sizeof(m_A));
+    MemorySnapShot_Store(m_M, sizeof(m_M));
+    MemorySnapShot_Store(m_L, sizeof(m_L));
+    MemorySnapShot_Store(&m_G, sizeof(m_G));
+    MemorySnapShot_Store(m_icache, sizeof(m_icache));
+    MemorySnapShot_Store(m_icache_vaddr, sizeof(m_icache_vaddr));
+    MemorySnapShot_Store(m_tlb_vaddr, sizeof(m_tlb_vaddr));
+    MemorySnapShot_Store(m_tlb_paddr, sizeof(m_tlb_paddr));
+    MemorySnapShot_Store((void*)&m_halt, sizeof(m_halt));
+    MemorySnapShot_Store(&m_flow, sizeof(m_flow));
+    MemorySnapShot_Store(&m_single_stepping, sizeof(m_single_stepping));
+    MemorySnapShot_Store(&m_fpcs, sizeof(m_fpcs));
+    MemorySnapShot_Store(&i860cycles, sizeof(i860cycles));
+    
+    if(!bSave)
+        set_mem_access(GET_EPSR_BE());
+    
+    if(ConfigureParams.Dimension.bI860Thread)
+        m_thread = host_thread_create(i860_cpu_device::thread, m_thread_name, this);
+}
+
 /* Message disaptcher - executed on i860 thread, safe to call i860 methods */
 bool i860_cpu_device::handle_msgs(int msg) {
-    if(msg & MSG_I860_KILL)
+    if(msg & MSG_I860_KILL) {
+        /* Keep pending requests for the next thread */
+        msg &= MSG_I860_RESET | MSG_INTR | MSG_DBG_BREAK;
+        if(msg)
+            nd->send_msg(msg);
         return false;
+    }
     
     if(msg & MSG_I860_RESET)
         reset();
@@ -545,23 +607,38 @@ bool i860_cpu_device::handle_msgs(int msg) {
     return true;
 }
 
+/* Block the i860 thread until there is something to do. Senders of
+ * messages and cycle budget refills call wake(), which posts only while
+ * the thread is parked. Work is re-checked after m_parked is set, so a
+ * wake-up between the check in run() and the wait is not lost. The
+ * timeout is a safety net only. */
+void i860_cpu_device::park(void) {
+    host_atomic_set(&m_parked, 1);
+    if(!nd->has_msgs() && (is_halted() || host_atomic_get(&i860cycles) <= 0))
+        host_sem_wait(m_wake, 100);
+    host_atomic_set(&m_parked, 0);
+}
+
+void i860_cpu_device::wake(void) {
+    if(host_atomic_get(&m_parked))
+        host_sem_post(m_wake);
+}
+
 void i860_cpu_device::run() {
     while(nd->handle_msgs()) {
-        
-        /* Sleep a bit if halted */
         if(is_halted()) {
-            host_sleep_ms(100);
+            park();
             continue;
         }
         
-        if (i860cycles > 0) {
+        if (host_atomic_get(&i860cycles) > 0) {
             /* Run some i860 cycles before re-checking messages */
             for(int i = 16; --i >= 0;)
                 run_cycle();
             
-            i860cycles -= 16;
+            host_atomic_add(&i860cycles, -16);
         } else {
-            host_sleep_ms(1);
+            park();
         }
     }
 }
@@ -69,26 +69,50 @@ typedef float64 FLOAT64;
 #define FLOAT64_ONE             LIT64(0x3FF0000000000000)
 #define FLOAT64_IS_NEG(x)       ((x) & LIT64(0x8000000000000000))
 #define FLOAT64_IS_ZERO(x)      (((x) & LIT64(0x7FFFFFFFFFFFFFFF)) == LIT64(0x0000000000000000))
+#define FLOAT32_IS_NAN(x)       (((x) & 0x7FFFFFFF) > 0x7F800000)
+#define FLOAT64_IS_NAN(x)       (((x) & LIT64(0x7FFFFFFFFFFFFFFF)) > LIT64(0x7FF0000000000000))
+
+#if WITH_HOSTFLOAT_I860
+#include <float.h>
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD != 0
+/* host evaluates with excess precision (x87), results would differ */
+#undef  WITH_HOSTFLOAT_I860
+#define WITH_HOSTFLOAT_I860 0
+#endif
+#endif
 
+#if WITH_HOSTFLOAT_I860
+#define float32_add(x,y)        host_float32_add(x,y)
+#define float32_sub(x,y)        host_float32_sub(x,y)
+#define float32_mul(x,y)        host_float32_mul(x,y)
+#define float32_div(x,y)        host_float32_div(x,y)
+#define float32_to_float64(x)   host_float32_to_float64(x)
+#define float64_add(x,y)        host_float64_add(x,y)
+#define float64_sub(x,y)        host_float64_sub(x,y)
+#define float64_mul(x,y)        host_float64_mul(x,y)
+#define float64_div(x,y)        host_float64_div(x,y)
+#define float64_to_float32(x)   host_float64_to_float32(x)
+#else
 #define float32_add(x,y)        float32_add(x,y,&m_fpcs)
 #define float32_sub(x,y)        float32_sub(x,y,&m_fpcs)
 #define float32_mul(x,y)        float32_mul(x,y,&m_fpcs)
 #define float32_div(x,y)        float32_div(x,y,&m_fpcs)
+#define float32_to_float64(x)   float32_to_float64(x,&m_fpcs)
+#define float64_add(x,y)        float64_add(x,y,&m_fpcs)
+#define float64_sub(x,y)        float64_sub(x,y,&m_fpcs)
+#define float64_mul(x,y)        float64_mul(x,y,&m_fpcs)
+#define float64_div(x,y)        float64_div(x,y,&m_fpcs)
+#define float64_to_float32(x)   float64_to_float32(x,&m_fpcs)
+#endif
 #define float32_sqrt(x)         float32_sqrt(x,&m_fpcs)
 #define float32_to_int32(x)     float32_to_int32(x,&m_fpcs)
 #define float32_to_int32_round_to_zero(x)     float32_to_int32_round_to_zero(x,&m_fpcs)
-#define float32_to_float64(x)   float32_to_float64(x,&m_fpcs)
 #define float32_gt(x,y)         float32_gt(x,y,&m_fpcs)
 #define float32_le(x,y)         float32_le(x,y,&m_fpcs)
 #define float32_eq(x,y)         float32_eq(x,y,&m_fpcs)
-#define float64_add(x,y)        float64_add(x,y,&m_fpcs)
-#define float64_sub(x,y)        float64_sub(x,y,&m_fpcs)
-#define float64_mul(x,y)        float64_mul(x,y,&m_fpcs)
-#define float64_div(x,y)        float64_div(x,y,&m_fpcs)
 #define float64_sqrt(x)         float64_sqrt(x,&m_fpcs)
 #define float64_to_int32(x)     float64_to_int32(x,&m_fpcs)
 #define float64_to_int32_round_to_zero(x)     float64_to_int32_round_to_zero(x,&m_fpcs)
-#define float64_to_float32(x)   float64_to_float32(x,&m_fpcs)
 #define float64_gt(x,y)         float64_gt(x,y,&m_fpcs)
 #define float64_le(x,y)         float64_le(x,y,&m_fpcs)
 #define float64_eq(x,y)         float64_eq(x,y,&m_fpcs)
@@ -431,21 +455,25 @@ public:
     
 	// construction/destruction
     i860_cpu_device(NextDimension* nd);
+    ~i860_cpu_device();
     
     /* External interface */
     void init(void);
     void set_run_func(void);
     void uninit(void);
+    void snapshot(bool bSave);
     void halt(bool state);
     void pause(bool state);
     inline bool is_halted(void) {return m_halt;};
 
-    /* i860 cycle counter */
-    int i860cycles;
+    /* i860 cycle budget, refilled from the m68k thread */
+    atomic_int i860cycles;
     /* Run one i860 cycle */
     void    run_cycle(void);
     /* Run the i860 thread */
     void run();
+    /* Wake the i860 thread if it is parked */
+    void wake(void);
     /* i860 thread message handler */
     bool   handle_msgs(int msg);
     
@@ -460,7 +488,29 @@ private:
     // softfloat control and status
     float_ctrl m_fpcs;
     
+#if WITH_HOSTFLOAT_I860
+    // host FPU fast path, only taken in round to nearest mode
+    bool m_host_fpu;
+    bool m_host_fpu_check; // compare every host result against softfloat
+    inline bool host_fpu(void) {return m_host_fpu && m_fpcs.float_rounding_mode == float_round_nearest_even;}
+    inline FLOAT32 host_float32_add(FLOAT32 x, FLOAT32 y);
+    inline FLOAT32 host_float32_sub(FLOAT32 x, FLOAT32 y);
+    inline FLOAT32 host_float32_mul(FLOAT32 x, FLOAT32 y);
+    inline FLOAT32 host_float32_div(FLOAT32 x, FLOAT32 y);
+    inline FLOAT64 host_float32_to_float64(FLOAT32 x);
+    inline FLOAT64 host_float64_add(FLOAT64 x, FLOAT64 y);
+    inline FLOAT64 host_float64_sub(FLOAT64 x, FLOAT64 y);
+    inline FLOAT64 host_float64_mul(FLOAT64 x, FLOAT64 y);
+    inline FLOAT64 host_float64_div(FLOAT64 x, FLOAT64 y);
+    inline FLOAT32 host_float64_to_float32(FLOAT64 x);
+#endif
+    
     thread_t*    m_thread;
+    
+    /* i860 thread parking while halted or out of cycles */
+    atomic_int   m_parked;
+    semaphore_t* m_wake;
+    void         park(void);
 
     UINT64 m_insn_decoded;
     UINT64 m_icache_hit;
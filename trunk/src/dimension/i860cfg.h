@@ -26,6 +26,8 @@
 #endif
 
 #define WITH_SOFTFLOAT_I860  1 
+/* Execute round-to-nearest IEEE operations on the host FPU (softfloat only) */
+#define WITH_HOSTFLOAT_I860  1
 
 /* Emulator configurations */
 
@@ -358,6 +358,7 @@ void i860_cpu_device::halt(bool state) {
     } else {
         Log_Printf(LOG_WARN, "[i860] **** RESTARTED ****");
         m_halt = false;
+        wake();
         Statusbar_SetNdLed(1);
     }
 }
@@ -369,6 +370,7 @@ void i860_cpu_device::pause(bool state) {
     } else {
         Log_Printf(LOG_WARN, "[i860] **** RESUMED ****");
         m_halt = false;
+        wake();
     }
 }
 
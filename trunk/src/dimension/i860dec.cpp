@@ -2160,6 +2160,64 @@ void i860_cpu_device::insn_flush (UINT32 insn)
 }
 
 
+#if WITH_HOSTFLOAT_I860
+/* Host FPU fast path. The host runs in round to nearest mode, other i860
+   rounding modes are left to softfloat. NaN results are recomputed with
+   softfloat to get the same NaN encoding. With bI860HostFPUCheck set
+   every host result is compared against softfloat and the softfloat
+   result is used on a mismatch. */
+static inline float   host_f32(FLOAT32 x) {float  f; memcpy(&f, &x, sizeof(f)); return f;}
+static inline double  host_f64(FLOAT64 x) {double d; memcpy(&d, &x, sizeof(d)); return d;}
+static inline FLOAT32 soft_f32(float  f)  {FLOAT32 x; memcpy(&x, &f, sizeof(x)); return x;}
+static inline FLOAT64 soft_f64(double d)  {FLOAT64 x; memcpy(&x, &d, sizeof(x)); return x;}
+
+#define HOSTFLOAT_CHECK(name, r, soft) do { \
+    if(m_host_fpu_check) { \
+        const UINT64 s = (soft); \
+        if(s != (UINT64)(r)) { \
+            Log_Printf(LOG_WARN, "[i860:%08X] Host FPU mismatch in " #name ": %016llX (softfloat %016llX)", \
+                       m_pc, (unsigned long long)(r), (unsigned long long)s); \
+            return s; \
+        } \
+    } } while(0)
+
+#define HOSTFLOAT_OP2(name, T, is_nan, to_host, to_soft, op) \
+inline T i860_cpu_device::host_##name(T x, T y) { \
+    if(host_fpu()) { \
+        const T r = to_soft(to_host(x) op to_host(y)); \
+        if(!is_nan(r)) { \
+            HOSTFLOAT_CHECK(name, r, (name)(x, y, &m_fpcs)); \
+            return r; \
+        } \
+    } \
+    return (name)(x, y, &m_fpcs); \
+}
+
+#define HOSTFLOAT_CVT(name, TS, TD, is_nan, to_host, to_soft) \
+inline TD i860_cpu_device::host_##name(TS x) { \
+    if(host_fpu()) { \
+        const TD r = to_soft(to_host(x)); \
+        if(!is_nan(r)) { \
+            HOSTFLOAT_CHECK(name, r, (name)(x, &m_fpcs)); \
+            return r; \
+        } \
+    } \
+    return (name)(x, &m_fpcs); \
+}
+
+HOSTFLOAT_OP2(float32_add, FLOAT32, FLOAT32_IS_NAN, host_f32, soft_f32, +)
+HOSTFLOAT_OP2(float32_sub, FLOAT32, FLOAT32_IS_NAN, host_f32, soft_f32, -)
+HOSTFLOAT_OP2(float32_mul, FLOAT32, FLOAT32_IS_NAN, host_f32, soft_f32, *)
+HOSTFLOAT_OP2(float32_div, FLOAT32, FLOAT32_IS_NAN, host_f32, soft_f32, /)
+HOSTFLOAT_OP2(float64_add, FLOAT64, FLOAT64_IS_NAN, host_f64, soft_f64, +)
+HOSTFLOAT_OP2(float64_sub, FLOAT64, FLOAT64_IS_NAN, host_f64, soft_f64, -)
+HOSTFLOAT_OP2(float64_mul, FLOAT64, FLOAT64_IS_NAN, host_f64, soft_f64, *)
+HOSTFLOAT_OP2(float64_div, FLOAT64, FLOAT64_IS_NAN, host_f64, soft_f64, /)
+HOSTFLOAT_CVT(float32_to_float64, FLOAT32, FLOAT64, FLOAT64_IS_NAN, (double)host_f32, soft_f64)
+HOSTFLOAT_CVT(float64_to_float32, FLOAT64, FLOAT32, FLOAT32_IS_NAN, (float)host_f64, soft_f32)
+#endif
+
+
 /* Execute "[p]fmul.{ss,sd,dd} fsrc1,fsrc2,fdest" instruction or
    pfmul3.dd fsrc1,fsrc2,fdest.
 
@@ -17,6 +17,9 @@
 #define ND_VRAM_SIZE	0x00400000
 #define ND_VRAM_MASK	0x003FFFFF
 
+/* Offset of the first visible pixel in VRAM, see blitDimension() */
+#define ND_VRAM_FB_OFFSET (ND_STEP ? 0 : 16*4)
+
 #define ND_EEPROM_START	0xFFF00000
 #define ND_EEPROM_SIZE	0x00020000
 #define ND_EEPROM_MASK	0x0001FFFF
@@ -96,6 +99,10 @@ public:
      void bput(Uint32 addr, Uint32 b) const {
         base[addr & mask] = b;
     }
+    
+    Uint8* hostptr(Uint32 addr) const {
+        return base + (addr & mask & ~ND_BANK_OFFSET_MASK);
+    }
 };
 
 class ND_Empty : public ND_Addrbank {
@@ -183,6 +190,7 @@ public:
             case 2: base[addr-2] = l >> 24; base[addr+1] = l >> 16; base[addr+4] = l >> 8; base[addr+3] = l; break;
             case 3: base[addr+0] = l >> 24; base[addr+3] = l >> 16; base[addr+2] = l >> 8; base[addr+1] = l; break;
         }
+        nd->sdl.vram_dirty(addr - ND_VRAM_FB_OFFSET);
     }
 
     Uint32 wget(Uint32 addr) const {
@@ -204,6 +212,7 @@ public:
             case 2: base[addr-2] = w >> 8; base[addr+1] = w; break;
             case 3: base[addr+0] = w >> 8; base[addr+3] = w; break;
         }
+        nd->sdl.vram_dirty(addr - ND_VRAM_FB_OFFSET);
     }
 
     Uint32 bget(Uint32 addr) const {
@@ -225,6 +234,7 @@ public:
             case 2: base[addr-2] = b; break;
             case 3: base[addr+0] = b; break;
         }
+        nd->sdl.vram_dirty(addr - ND_VRAM_FB_OFFSET);
     }
 };
 
@@ -388,6 +398,10 @@ void ND_Addrbank::bput(Uint32 addr, Uint32 b) const {
     Log_Printf(LOG_ND_MEM, "[ND] Slot %i: Illegal bput at %08X\n",nd->slot,addr);
 }
 
+Uint8* ND_Addrbank::hostptr(Uint32 addr) const {
+    return NULL;
+}
+
 /* NeXTdimension device space */
 
 class ND_IO : public ND_Addrbank {
@@ -442,15 +456,19 @@ public:
 };
 
 void NextDimension::map_banks (ND_Addrbank *bank, int start, int size) {
-    for (int bnr = start; bnr < start + size; bnr++)
+    for (int bnr = start; bnr < start + size; bnr++) {
         nd_put_mem_bank (bnr << 16, bank);
+        nd_put_mem_host (bnr << 16, bank->hostptr(bnr << 16));
+    }
     return;
 }
 
 void NextDimension::init_mem_banks(void) {
     ND_Addrbank* nd_illegal_bank = new ND_Addrbank(this);
-    for (int i = 0; i < 65536; i++)
+    for (int i = 0; i < 65536; i++) {
         nd_put_mem_bank(i<<16, nd_illegal_bank);
+        nd_put_mem_host(i<<16, NULL);
+    }
 }
 
 #define write_log printf
@@ -28,6 +28,10 @@ typedef void (*nd_mem_put_func)(int, uaecptr, uae_u32) REGPARAM;
 
 #define nd_bankindex(addr) (((uaecptr)(addr)) >> 16)
 #define nd_put_mem_bank(addr, b) (mem_banks[nd_bankindex(addr)] = (b))
+#define nd_put_mem_host(addr, p) (mem_host[nd_bankindex(addr)] = (p))
+
+/* Offset into a 64k bank */
+#define ND_BANK_OFFSET_MASK 0x0000FFFF
 
 #ifdef __cplusplus
 }
@@ -47,6 +51,10 @@ public:
     virtual void wput(Uint32 addr, Uint32 val) const;
     virtual void bput(Uint32 addr, Uint32 val) const;
     
+    /* Host pointer to the start of a 64k bank holding plain big endian
+       memory, NULL if the bank needs the access functions above. */
+    virtual Uint8* hostptr(Uint32 addr) const;
+    
     ND_Addrbank(NextDimension* nd);
 };
 
@@ -6,6 +6,7 @@
 #include "nd_nbic.hpp"
 #include "dimension.hpp"
 #include "log.h"
+#include "memorySnapShot.h"
 
 /* NeXTdimention NBIC */
 #define ND_NBIC_INTR    0x80
@@ -57,9 +58,9 @@ void  NBIC::write(int addr, Uint8 val) {
             Log_Printf(ND_LOG_IO_WR, "[ND] Slot %i: NBIC Interrupt mask write %02X at %08X", slot,val,addr);
             intmask = val;
             if(val & ND_NBIC_INTR)
-                remInterMask |= 1 << slot;
+                host_atomic_or(&remInterMask, 1 << slot);
             else
-                remInterMask &= ~(1 << slot);
+                host_atomic_and(&remInterMask, ~(1 << slot));
             break;
         case 0x0D:
         case 0x0E:
@@ -133,10 +134,10 @@ void NBIC::bput(Uint32 addr, Uint8 b) {
 void NBIC::set_intstatus(bool set) {
 	if (set) {
         intstatus |= ND_NBIC_INTR;
-        remInter  |= 1 << slot;
+        host_atomic_or(&remInter, 1 << slot);
 	} else {
         intstatus &= ~ND_NBIC_INTR;
-        remInter  &= ~(1 << slot);
+        host_atomic_and(&remInter, ~(1 << slot));
 	}
 }
 
@@ -147,17 +148,32 @@ void NBIC::init(void) {
     /* Release any interrupt that may be pending */
     intmask      = 0;
     intstatus    = 0;
-    remInter     = 0;
-    remInterMask = 0;
+    host_atomic_set(&remInter, 0);
+    host_atomic_set(&remInterMask, 0);
     set_interrupt(INT_REMOTE, RELEASE_INT);
 }
 
-volatile Uint32 NBIC::remInter;
-volatile Uint32 NBIC::remInterMask;
+atomic_int NBIC::remInter;
+atomic_int NBIC::remInterMask;
+
+/* Save/restore NBIC state */
+void NBIC::snapshot(bool bSave) {
+    Uint32 inter = host_atomic_get(&remInter);
+    Uint32 mask  = host_atomic_get(&remInterMask);
+    
+    MemorySnapShot_Store(&id, sizeof(id));
+    MemorySnapShot_Store(&intstatus, sizeof(intstatus));
+    MemorySnapShot_Store(&intmask, sizeof(intmask));
+    MemorySnapShot_Store(&inter, sizeof(inter));
+    MemorySnapShot_Store(&mask, sizeof(mask));
+    
+    host_atomic_set(&remInter, inter);
+    host_atomic_set(&remInterMask, mask);
+}
 
 /* Interrupt function, called from ,68k thread */
 void nd_nbic_interrupt(void) {
-    if (NBIC::remInter&NBIC::remInterMask) {
+    if (host_atomic_get(&NBIC::remInter) & host_atomic_get(&NBIC::remInterMask)) {
         set_interrupt(INT_REMOTE, SET_INT);
     } else {
         set_interrupt(INT_REMOTE, RELEASE_INT);
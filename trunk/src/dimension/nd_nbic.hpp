@@ -3,6 +3,8 @@
 #ifndef __ND_NBIC_H__
 #define __ND_NBIC_H__
 
+#include "host.h"
+
 #define ND_NBIC_ID        0xC0000001
 
 #ifdef __cplusplus
@@ -14,8 +16,10 @@ class NBIC {
     Uint8  intstatus;
     Uint8  intmask;
 public:
-    static volatile Uint32 remInter;
-    static volatile Uint32 remInterMask;
+    /* Interrupt lines of all boards, one bit per slot. Written from the
+       i860 threads, read from the m68k thread. */
+    static atomic_int remInter;
+    static atomic_int remInterMask;
 
     NBIC(int slot, int id);
     
@@ -31,6 +35,7 @@ public:
     
     void   init(void);
     void   set_intstatus(bool set);
+    void   snapshot(bool bSave);
 };
 
 extern "C" {
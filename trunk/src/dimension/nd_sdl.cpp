@@ -15,7 +15,29 @@ const int BLANK_MS       = 2;         // Give some blank time for both
 volatile bool NDSDL::ndVBLtoggle;
 volatile bool NDSDL::ndVideoVBLtoggle;
 
-NDSDL::NDSDL(int slot, Uint32* vram) : slot(slot), doRepaint(true), repaintThread(NULL), ndWindow(NULL), ndRenderer(NULL), vram(vram) {}
+/* Static frames are polled at display rate for ND_IDLE_FRAMES frames, then
+ * every ND_IDLE_MS milliseconds until the i860 or the m68k touch VRAM */
+const int ND_IDLE_FRAMES = 68;
+const int ND_IDLE_MS     = 50;
+
+NDSDL::NDSDL(int slot, Uint32* vram) : slot(slot), doRepaint(true), repaintThread(NULL), ndWindow(NULL), ndRenderer(NULL), vram(vram) {
+    set_dirty();
+}
+
+/* Fetch and clear the dirty scanline bits, return true if any was set */
+bool NDSDL::get_dirty(Uint32* lines) {
+    Uint32 any = 0;
+    for (int i = 0; i < ND_DIRTY_WORDS; i++) {
+        lines[i] = SDL_AtomicSet(&dirty[i], 0);
+        any     |= lines[i];
+    }
+    return any != 0;
+}
+
+void NDSDL::set_dirty(void) {
+    for (int i = 0; i < ND_DIRTY_WORDS; i++)
+        SDL_AtomicSet(&dirty[i], -1);
+}
 
 int NDSDL::repainter(void *_this) {
     return ((NDSDL*)_this)->repainter();
@@ -40,11 +62,20 @@ int NDSDL::repainter(void) {
     
     SDL_AtomicSet(&blitNDFB, 1);
     
+    Uint32 lines[ND_DIRTY_WORDS];
+    int    idleFrames = 0;
+    
     while(doRepaint) {
         if (SDL_AtomicGet(&blitNDFB)) {
-            blitDimension(vram, ndTexture);
-            SDL_RenderCopy(ndRenderer, ndTexture, NULL, NULL);
-            SDL_RenderPresent(ndRenderer);
+            if (get_dirty(lines)) {
+                blitDimension(vram, ndTexture, lines);
+                SDL_RenderCopy(ndRenderer, ndTexture, NULL, NULL);
+                SDL_RenderPresent(ndRenderer);
+                idleFrames = 0;
+            } else {
+                // static frame: nothing to upload or present, back off
+                host_sleep_ms(++idleFrames < ND_IDLE_FRAMES ? DISPLAY_VBL_MS : ND_IDLE_MS);
+            }
         } else {
             host_sleep_ms(100);
         }
@@ -58,6 +89,8 @@ int NDSDL::repainter(void) {
 }
 
 void NDSDL::init(void) {
+    if (bHeadless) return;
+    
     if(!(repaintThread)) {
         int x, y, w, h;
         char title[32];
@@ -82,7 +115,7 @@ void NDSDL::init(void) {
 void NDSDL::start_interrupts() {
     char name[32];
     
-    if (!(repaintThread) && ConfigureParams.Screen.nMonitorType == MONITOR_TYPE_DUAL) {
+    if (!(repaintThread) && !bHeadless && ConfigureParams.Screen.nMonitorType == MONITOR_TYPE_DUAL) {
         sprintf(name, "[ND] Slot %i: Repainter", slot);
         repaintThread = SDL_CreateThread(NDSDL::repainter, name, this);
     }
@@ -98,7 +131,10 @@ void nd_vbl_handler(void)       {
     FOR_EACH_SLOT(slot) {
         IF_NEXT_DIMENSION(slot, nd) {
             host_blank(nd->slot, ND_DISPLAY, NDSDL::ndVBLtoggle);
-            nd->i860.i860cycles = (1000*1000*33)/136;
+            host_atomic_set(&nd->i860.i860cycles, (1000*1000*33)/136);
+            /* a halted i860 is woken up by the message that restarts it */
+            if(!nd->i860.is_halted())
+                nd->i860.wake();
         }
     }
     NDSDL::ndVBLtoggle = !NDSDL::ndVBLtoggle;
@@ -123,13 +159,22 @@ void nd_video_vbl_handler(void) {
 }
 
 void NDSDL::uninit(void) {
-    SDL_HideWindow(ndWindow);
+    if (ndWindow) SDL_HideWindow(ndWindow);
 }
 
 void NDSDL::pause(bool pause) {
+    if (!pause) set_dirty();
     SDL_AtomicSet(&blitNDFB, pause ? 0 : 1);
 }
 
+void nd_sdl_refresh(void) {
+    FOR_EACH_SLOT(slot) {
+        IF_NEXT_DIMENSION(slot, nd) {
+            nd->sdl.set_dirty();
+        }
+    }
+}
+
 void nd_sdl_destroy(void) {
     FOR_EACH_SLOT(slot) {
         IF_NEXT_DIMENSION(slot, nd) {
@@ -140,7 +185,9 @@ void nd_sdl_destroy(void) {
 
 void NDSDL::destroy(void) {
     doRepaint = false; // stop repaint thread
-    int s;
-    SDL_WaitThread(repaintThread, &s);
+    if (repaintThread) {
+        int s;
+        SDL_WaitThread(repaintThread, &s);
+    }
     uninit();
 }
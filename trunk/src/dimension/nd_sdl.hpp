@@ -6,6 +6,12 @@
 #include <SDL.h>
 #include <SDL_thread.h>
 #include "cycInt.h"
+#include "host.h"
+
+/* VRAM scanline geometry for dirty tracking */
+#define ND_VRAM_LINES       832
+#define ND_VRAM_LINE_BYTES  ((1120 + 32) * 4)
+#define ND_DIRTY_WORDS      ((ND_VRAM_LINES + 31) / 32)
 
 #ifdef __cplusplus
 
@@ -17,6 +23,7 @@ class NDSDL {
     SDL_Renderer* ndRenderer;
     SDL_atomic_t  blitNDFB;
     Uint32*       vram;
+    SDL_atomic_t  dirty[ND_DIRTY_WORDS]; /* one bit per VRAM scanline */
     
     static int    repainter(void *_this);
     int           repainter(void);
@@ -30,6 +37,23 @@ public:
     void    pause(bool pause);
     void    destroy(void);
     void    start_interrupts();
+    bool    get_dirty(Uint32* lines);
+    void    set_dirty(void);
+    
+    /* Mark the scanline at byte offset into the visible framebuffer dirty.
+     * Both the m68k and the i860 thread store to VRAM, so the bit is set
+     * atomically, but only if it is not already pending. The barrier
+     * orders the pixel store before the bit. */
+    inline void vram_dirty(Uint32 offset) {
+        Uint32 line = offset / ND_VRAM_LINE_BYTES;
+        if (line < ND_VRAM_LINES) {
+            atomic_int* d = &dirty[line >> 5];
+            int bit = (int)(1u << (line & 31));
+            SDL_MemoryBarrierRelease();
+            if (!(d->value & bit))
+                host_atomic_or(d, bit);
+        }
+    }
 };
 
 extern "C" {
@@ -41,6 +65,7 @@ extern "C" {
     void nd_vbl_handler(void);
     void nd_video_vbl_handler(void);    
     void nd_sdl_destroy(void);
+    void nd_sdl_refresh(void);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,289 @@
+/*
+  Previous - diskio.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Write-behind queue for disk images. Writes are copied to a bounded queue
+  and written to the image by a separate I/O thread, so the emulation does
+  not wait for the host storage. Reads are served from the image and then
+  patched with all queued writes to the same file, oldest first, so the
+  guest always reads back what it has written. Queued writes to a file are
+  written in the order they were issued. DiskIO_Flush waits until all
+  writes to a file have been written, it has to be called before a disk
+  image is closed or written by other means. A failed write is recorded
+  for its file and reported by the next DiskIO_Flush of that file.
+  The queue is only used if the host has pread and pwrite, because the I/O
+  thread and the emulation access the same file at the same time.
+*/
+
+const char DiskIO_fileid[] = "Previous diskio.c : " __DATE__ " " __TIME__;
+
+#include "main.h"
+#include "configuration.h"
+#include "file.h"
+#include "host.h"
+#include "log.h"
+#include "diskio.h"
+
+#if HAVE_PREAD && HAVE_PWRITE
+#include <unistd.h>
+#define DISKIO_THREAD       1
+#else
+#define DISKIO_THREAD       0
+#endif
+
+#define DISKIO_MAX_WRITES   256
+#define DISKIO_MAX_BYTES    (4*1024*1024)
+#define DISKIO_MAX_ERRORS   16  /* more than disk images can be open */
+
+typedef struct {
+    FILE*  fp;
+    Uint8* data;
+    Uint32 size;
+    Uint64 offset;
+} diskio_write_t;
+
+static diskio_write_t diskio_queue[DISKIO_MAX_WRITES];
+static Uint32     diskio_head;   /* oldest entry, written by the I/O thread */
+static Uint32     diskio_count;  /* entries in the queue */
+static Uint32     diskio_bytes;  /* data bytes in the queue */
+static FILE*      diskio_error[DISKIO_MAX_ERRORS]; /* files with failed writes */
+static bool       diskio_quit;
+static bool       diskio_failed; /* I/O thread could not be started */
+static thread_t*  diskio_thread;
+static SDL_mutex* diskio_mutex;
+static SDL_cond*  diskio_work;   /* signalled when an entry is added */
+static SDL_cond*  diskio_done;   /* signalled when an entry is removed */
+
+
+#if DISKIO_THREAD
+/* Record a failed write to the file until it is reported */
+static void diskio_set_error(FILE *fp) {
+    Uint32 i;
+
+    for (i = 0; i < DISKIO_MAX_ERRORS && diskio_error[i] != fp; i++) {
+        if (!diskio_error[i]) {
+            diskio_error[i] = fp;
+            break;
+        }
+    }
+}
+
+/* Check and clear the write errors of the file, all files if fp is NULL */
+static bool diskio_take_error(FILE *fp) {
+    bool failed = false;
+    Uint32 i;
+
+    for (i = 0; i < DISKIO_MAX_ERRORS; i++) {
+        if (diskio_error[i] && (!fp || diskio_error[i] == fp)) {
+            diskio_error[i] = NULL;
+            failed = true;
+        }
+    }
+    return failed;
+}
+
+static int diskio_thread_func(void *data) {
+    diskio_write_t w;
+    bool ok;
+
+    SDL_LockMutex(diskio_mutex);
+    for (;;) {
+        while (!diskio_count && !diskio_quit) {
+            SDL_CondWait(diskio_work, diskio_mutex);
+        }
+        if (!diskio_count) {
+            break;
+        }
+        /* The entry stays in the queue while it is written, reads still
+         * see its data until the write is complete */
+        w = diskio_queue[diskio_head];
+        SDL_UnlockMutex(diskio_mutex);
+
+        ok = File_Write(w.data, w.size, w.offset, w.fp);
+        if (!ok) {
+            Log_Printf(LOG_WARN, "[DiskIO] Write of %d bytes at offset %lld failed", w.size, (long long)w.offset);
+        }
+
+        SDL_LockMutex(diskio_mutex);
+        if (!ok) {
+            diskio_set_error(w.fp);
+        }
+        free(w.data);
+        diskio_head = (diskio_head + 1) % DISKIO_MAX_WRITES;
+        diskio_count--;
+        diskio_bytes -= w.size;
+        SDL_CondBroadcast(diskio_done);
+    }
+    SDL_UnlockMutex(diskio_mutex);
+    return 0;
+}
+
+static bool diskio_start(void) {
+    if (diskio_thread) {
+        return true;
+    }
+    if (diskio_failed) {
+        return false;
+    }
+    diskio_mutex = SDL_CreateMutex();
+    diskio_work  = SDL_CreateCond();
+    diskio_done  = SDL_CreateCond();
+    if (diskio_mutex && diskio_work && diskio_done) {
+        diskio_quit   = false;
+        diskio_thread = host_thread_create(diskio_thread_func, "[DiskIO] I/O thread", NULL);
+        if (diskio_thread) {
+            Log_Printf(LOG_WARN, "[DiskIO] Using separate thread for disk writes");
+            return true;
+        }
+    }
+    Log_Printf(LOG_WARN, "[DiskIO] Cannot start I/O thread, writing synchronously");
+    DiskIO_UnInit();
+    diskio_failed = true;
+    return false;
+}
+
+/* Check if there are queued writes to the file, all files if fp is NULL */
+static bool diskio_pending(FILE *fp) {
+    Uint32 i;
+
+    if (!fp) {
+        return diskio_count > 0;
+    }
+    for (i = 0; i < diskio_count; i++) {
+        if (diskio_queue[(diskio_head + i) % DISKIO_MAX_WRITES].fp == fp) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Wait until all queued writes to the file have been written */
+static void diskio_wait(FILE *fp) {
+    if (diskio_thread) {
+        SDL_LockMutex(diskio_mutex);
+        while (diskio_pending(fp)) {
+            SDL_CondWait(diskio_done, diskio_mutex);
+        }
+        SDL_UnlockMutex(diskio_mutex);
+    }
+}
+#endif /* DISKIO_THREAD */
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Read data from a disk image. Data written by queued writes is returned
+ * even if it has not been written to the image yet.
+ */
+bool DiskIO_Read(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp) {
+    diskio_write_t* w;
+    Uint64 start, end;
+    Uint32 i;
+    bool ok;
+
+    if (map || !diskio_thread) {
+        return File_MapRead(map, data, size, offset, fp);
+    }
+
+    SDL_LockMutex(diskio_mutex);
+    ok = File_Read(data, size, offset, fp);
+    for (i = 0; i < diskio_count; i++) {
+        w = &diskio_queue[(diskio_head + i) % DISKIO_MAX_WRITES];
+        if (w->fp != fp || w->offset >= offset + size || w->offset + w->size <= offset) {
+            continue;
+        }
+        start = w->offset > offset ? w->offset : offset;
+        end   = w->offset + w->size < offset + size ? w->offset + w->size : offset + size;
+        memcpy(data + (start - offset), w->data + (start - w->offset), end - start);
+    }
+    SDL_UnlockMutex(diskio_mutex);
+    return ok;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Write data to a disk image. If the I/O thread is enabled the data is
+ * queued and the function returns immediately unless the queue is full.
+ * Mapped images are always written directly.
+ */
+bool DiskIO_Write(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp) {
+#if DISKIO_THREAD
+    Uint8* copy;
+
+    if (map || !ConfigureParams.System.bAsyncDiskIO || size > DISKIO_MAX_BYTES ||
+        !diskio_start() || !(copy = malloc(size))) {
+        /* Keep the order of writes that are still queued */
+        diskio_wait(fp);
+        return File_MapWrite(map, data, size, offset, fp);
+    }
+    memcpy(copy, data, size);
+
+    SDL_LockMutex(diskio_mutex);
+    while (diskio_count == DISKIO_MAX_WRITES || diskio_bytes + size > DISKIO_MAX_BYTES) {
+        SDL_CondWait(diskio_done, diskio_mutex);
+    }
+    diskio_queue[(diskio_head + diskio_count) % DISKIO_MAX_WRITES] = (diskio_write_t){ fp, copy, size, offset };
+    diskio_count++;
+    diskio_bytes += size;
+    SDL_CondSignal(diskio_work);
+    SDL_UnlockMutex(diskio_mutex);
+    return true;
+#else
+    return File_MapWrite(map, data, size, offset, fp);
+#endif
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Wait until all queued writes to the file have been written, or all
+ * queued writes if fp is NULL. If sync is true the file is also written
+ * to the host storage. Returns false if a queued write to the file failed
+ * since the last call or if the file could not be synced.
+ */
+bool DiskIO_Flush(FILE *fp, bool sync) {
+    bool ok = true;
+#if DISKIO_THREAD
+    diskio_wait(fp);
+    if (diskio_thread) {
+        SDL_LockMutex(diskio_mutex);
+        ok = !diskio_take_error(fp);
+        SDL_UnlockMutex(diskio_mutex);
+    } else {
+        ok = !diskio_take_error(fp);
+    }
+    if (fp && sync && fsync(fileno(fp))) {
+        Log_Printf(LOG_WARN, "[DiskIO] Cannot sync disk image");
+        ok = false;
+    }
+#endif
+    return ok;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Write all queued data and stop the I/O thread.
+ */
+void DiskIO_UnInit(void) {
+    if (diskio_thread) {
+        SDL_LockMutex(diskio_mutex);
+        diskio_quit = true;
+        SDL_CondSignal(diskio_work);
+        SDL_UnlockMutex(diskio_mutex);
+        host_thread_wait(diskio_thread);
+        diskio_thread = NULL;
+    }
+    if (diskio_done) {
+        SDL_DestroyCond(diskio_done);
+        diskio_done = NULL;
+    }
+    if (diskio_work) {
+        SDL_DestroyCond(diskio_work);
+        diskio_work = NULL;
+    }
+    if (diskio_mutex) {
+        SDL_DestroyMutex(diskio_mutex);
+        diskio_mutex = NULL;
+    }
+}
@@ -25,6 +25,7 @@
 #include "mmu_common.h"
 #include "kms.h"
 #include "audio.h"
+#include "memorySnapShot.h"
 
 #define LOG_DMA_LEVEL LOG_DEBUG
 
@@ -393,6 +394,43 @@ void dma_interrupt(int channel) {
 /* DMA Read and Write Memory Functions */
 
 /* Channel SCSI (shared with floppy drive) */
+static bool dma_esp_write_ram(void) {
+    /* Copy whole bursts from the SCSI buffer directly to RAM. This is only
+     * done while the DMA channel FIFO is empty and the target is plain RAM.
+     * Returns false if nothing could be copied. */
+    Uint32 addr = dma[CHANNEL_SCSI].next;
+    Uint8* host = get_bank_hostptr(bank_hostptr_w, addr);
+    int len, n;
+    
+    if (host==NULL || espdma_buf_limit>0 || SCSIbus.phase!=PHASE_DI) {
+        return false;
+    }
+    len = dma[CHANNEL_SCSI].limit-addr;
+    if (len>0x10000-(int)(addr&0xFFFF)) {
+        len = 0x10000-(addr&0xFFFF);
+    }
+    if ((Uint32)len>esp_counter) {
+        len = esp_counter;
+    }
+    if (len>scsi_buffer.size) {
+        len = scsi_buffer.size;
+    }
+    len -= len%DMA_BURST_SIZE;
+    if (len<=0) {
+        return false;
+    }
+    
+    n = SCSIdisk_Send_Block(host, len);
+    esp_counter -= n;
+    dma[CHANNEL_SCSI].next += n;
+    
+    /* Status toggles once per burst */
+    if ((n/DMA_BURST_SIZE)&1) {
+        ESP_DMA_set_status();
+    }
+    return n>0;
+}
+
 void dma_esp_write_memory(void) {
     Log_Printf(LOG_DMA_LEVEL, "[DMA] Channel SCSI: Write to memory at $%08x, %i bytes (ESP counter %i)",
                dma[CHANNEL_SCSI].next,dma[CHANNEL_SCSI].limit-dma[CHANNEL_SCSI].next,esp_counter);
@@ -413,6 +451,9 @@ void dma_esp_write_memory(void) {
         }
 
         while (dma[CHANNEL_SCSI].next<=dma[CHANNEL_SCSI].limit) {
+            if (!floppy_select && dma_esp_write_ram()) {
+                continue;
+            }
             /* Fill DMA channel FIFO (only if limit < FIFO size) */
             if (espdma_buf_limit<DMA_BURST_SIZE) {
                 if (floppy_select) {
@@ -1191,3 +1232,22 @@ void tdma_flush_buffer(int channel) {
 	
 	dma_interrupt(CHANNEL_SCSI);
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of DMA variables ('MemorySnapShot_Store' handles type)
+ */
+void DMA_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(dma, sizeof(dma));
+    MemorySnapShot_Store(&espdma_buf_size, sizeof(espdma_buf_size));
+    MemorySnapShot_Store(&espdma_buf_limit, sizeof(espdma_buf_limit));
+    MemorySnapShot_Store(espdma_buf, sizeof(espdma_buf));
+    MemorySnapShot_Store(&modma_buf_size, sizeof(modma_buf_size));
+    MemorySnapShot_Store(&modma_buf_limit, sizeof(modma_buf_limit));
+    MemorySnapShot_Store(modma_buf, sizeof(modma_buf));
+    MemorySnapShot_Store(&saved_next_turbo, sizeof(saved_next_turbo));
+    MemorySnapShot_Store(m2m_buffer, sizeof(m2m_buffer));
+    MemorySnapShot_Store(&m2m_buffer_size, sizeof(m2m_buffer_size));
+}
@@ -33,6 +33,9 @@
 #include "m68000.h"
 #include "sysReg.h"
 #include "dma.h"
+#include "host.h"
+#include "memorySnapShot.h"
+#include "debugui.h"
 
 #if ENABLE_DSP_EMU
 #include "dsp_cpu.h"
@@ -62,6 +65,40 @@ static const char* x_ext_memory_addr_name[] = {
 };
 
 static Sint32 save_cycles;
+
+/* DSP thread
+ *
+ * When enabled the DSP executes on its own host thread. The m68k thread
+ * grants DSP cycles through dsp_cycles and waits if the DSP falls behind
+ * by more than nDSPMaxSkew cycles. The DSP never runs ahead of the m68k.
+ * All accesses to dsp_core from the m68k thread are done holding
+ * dsp_lock, the DSP thread holds it while executing a slice of
+ * instructions. Interrupt requests to the m68k are passed back through
+ * dsp_host_intr and raised on the m68k thread, as are requests to enter
+ * the debugger through dsp_break.
+ * Both threads spin for a while before they block on a semaphore. A thread
+ * that is about to block sets its flag (dsp_idle, dsp_waiting) and checks
+ * its condition again, the other thread posts the semaphore if it finds
+ * the flag set after changing dsp_cycles.
+ */
+#define DSP_THREAD_SLICE  128    /* DSP cycles to execute per lock */
+#define DSP_THREAD_SPIN   1000   /* idle polls before sleeping */
+#define DSP_WAIT_SPIN     1000   /* m68k polls before sleeping */
+
+#ifndef SDL_CPUPauseInstruction
+#define SDL_CPUPauseInstruction()
+#endif
+
+static thread_t*    dsp_thread;
+static lock_t       dsp_lock;
+static atomic_int   dsp_cycles;
+static atomic_int   dsp_thread_quit;
+static atomic_int   dsp_host_intr;  /* pending interrupt state + 1 or 0 */
+static atomic_int   dsp_break;      /* DSP exception, enter debugger */
+static atomic_int   dsp_idle;       /* DSP thread blocks on dsp_wakeup */
+static atomic_int   dsp_waiting;    /* m68k thread blocks on dsp_caught_up */
+static semaphore_t* dsp_wakeup;
+static semaphore_t* dsp_caught_up;
 #endif
 
 static bool bDspDebugging;
@@ -70,6 +107,9 @@ bool bDspEnabled = false;
 bool bDspEmulated = false;
 bool bDspHostInterruptPending = false;
 
+Uint8 dsp_intr_at_block_end;
+Uint8 dsp_dma_unpacked;
+
 
 /**
  * Handle TXD interrupt at host CPU
@@ -87,6 +127,34 @@ void DSP_HandleTXD(int set) {
 #endif
 
 
+/**
+ * Set DSP interrupt at the host CPU. If the DSP runs on its own thread
+ * the request is deferred to DSP_UpdateHostInterrupt().
+ */
+#if ENABLE_DSP_EMU
+static void DSP_SetHostInterrupt(Uint8 state)
+{
+	if (dsp_thread) {
+		host_atomic_set(&dsp_host_intr, state+1);
+	} else {
+		set_dsp_interrupt(state);
+	}
+}
+
+/**
+ * Raise or release pending DSP interrupt. Called on the m68k thread.
+ */
+static void DSP_UpdateHostInterrupt(void)
+{
+	int state = host_atomic_set(&dsp_host_intr, 0);
+	
+	if (state) {
+		set_dsp_interrupt(state-1);
+	}
+}
+#endif
+
+
 /**
  * Handle HREQ at the host CPU.
  */
@@ -94,7 +162,7 @@ void DSP_HandleTXD(int set) {
 static void DSP_HandleHREQ(int set)
 {
     if (dsp_core.dma_mode) {
-		set_dsp_interrupt(RELEASE_INT);
+		DSP_SetHostInterrupt(RELEASE_INT);
         if (set) {
 			dsp_core.dma_request = 1;
         } else {
@@ -104,10 +172,10 @@ static void DSP_HandleHREQ(int set)
 		dsp_core.dma_request = 0;
         if (set) {
             Log_Printf(LOG_DSP_LEVEL, "[DSP] Set HREQ interrupt");
-			set_dsp_interrupt(SET_INT);
+			DSP_SetHostInterrupt(SET_INT);
         } else {
             Log_Printf(LOG_DSP_LEVEL, "[DSP] Release HREQ interrupt");
-			set_dsp_interrupt(RELEASE_INT);
+			DSP_SetHostInterrupt(RELEASE_INT);
         }
     }
 }
@@ -120,6 +188,7 @@ static void DSP_HandleHREQ(int set)
 
 /**
  * Set DSP IRQB at the end of a DMA block.
+ * Only called from DSP_HandleDMA(), with dsp_lock held.
  */
 void DSP_SetIRQB(void)
 {
@@ -190,6 +259,149 @@ bool	DSP_ProcessIRQ(void)
 #endif
 
 
+/**
+ * Access DSP host port from the m68k thread
+ */
+#if ENABLE_DSP_EMU
+static Uint8 DSP_ReadHost(int addr)
+{
+	Uint8 value;
+	
+	if (!dsp_thread)
+		return dsp_core_read_host(addr);
+	
+	host_lock(&dsp_lock);
+	value = dsp_core_read_host(addr);
+	host_unlock(&dsp_lock);
+	DSP_UpdateHostInterrupt();
+	return value;
+}
+
+static void DSP_WriteHost(int addr, Uint8 value)
+{
+	if (!dsp_thread) {
+		dsp_core_write_host(addr, value);
+		return;
+	}
+	
+	host_lock(&dsp_lock);
+	dsp_core_write_host(addr, value);
+	host_unlock(&dsp_lock);
+	DSP_UpdateHostInterrupt();
+}
+#endif
+
+
+/**
+ * DSP thread main loop
+ */
+#if ENABLE_DSP_EMU
+static int DSP_Thread(void* data)
+{
+	int cycles, done;
+	int idle = 0;
+	
+	while (!host_atomic_get(&dsp_thread_quit)) {
+		cycles = host_atomic_get(&dsp_cycles);
+		if (cycles <= 0 || host_atomic_get(&dsp_break)) {
+			/* Poll for a while before giving up the core */
+			if (idle < DSP_THREAD_SPIN) {
+				idle++;
+				SDL_CPUPauseInstruction();
+				continue;
+			}
+			host_atomic_set(&dsp_idle, 1);
+			if (host_atomic_get(&dsp_cycles) <= 0 || host_atomic_get(&dsp_break)) {
+				host_sem_wait(dsp_wakeup, SDL_MUTEX_MAXWAIT);
+			}
+			host_atomic_set(&dsp_idle, 0);
+			continue;
+		}
+		idle = 0;
+		done = 0;
+		
+		host_lock(&dsp_lock);
+		if (dsp_core.running) {
+			while (done < cycles && done < DSP_THREAD_SLICE && !host_atomic_get(&dsp_break)) {
+				dsp56k_execute_instruction();
+				done += dsp_core.instr_cycle;
+			}
+		} else {
+			done = cycles;
+		}
+		host_unlock(&dsp_lock);
+		
+		host_atomic_add(&dsp_cycles, -done);
+		if (host_atomic_get(&dsp_waiting) && host_atomic_cas(&dsp_waiting, 1, 0)) {
+			host_sem_post(dsp_caught_up);
+		}
+	}
+	return 0;
+}
+
+/* Wake up the DSP thread if it is blocked */
+static void DSP_WakeThread(void)
+{
+	if (host_atomic_get(&dsp_idle) && host_atomic_cas(&dsp_idle, 1, 0)) {
+		host_sem_post(dsp_wakeup);
+	}
+}
+
+/* Wait until the DSP thread is no more than nDSPMaxSkew cycles behind */
+static void DSP_WaitThread(void)
+{
+	int spin = 0;
+	
+	while (host_atomic_get(&dsp_cycles) > ConfigureParams.System.nDSPMaxSkew &&
+	       !host_atomic_get(&dsp_break)) {
+		if (spin < DSP_WAIT_SPIN) {
+			spin++;
+			SDL_CPUPauseInstruction();
+			continue;
+		}
+		host_atomic_set(&dsp_waiting, 1);
+		if (host_atomic_get(&dsp_cycles) > ConfigureParams.System.nDSPMaxSkew &&
+		    !host_atomic_get(&dsp_break)) {
+			host_sem_wait(dsp_caught_up, 1);
+		}
+		host_atomic_set(&dsp_waiting, 0);
+	}
+}
+
+static void DSP_StartThread(void)
+{
+	if (dsp_thread)
+		return;
+	
+	host_atomic_set(&dsp_cycles, 0);
+	host_atomic_set(&dsp_thread_quit, 0);
+	host_atomic_set(&dsp_host_intr, 0);
+	host_atomic_set(&dsp_break, 0);
+	host_atomic_set(&dsp_idle, 0);
+	host_atomic_set(&dsp_waiting, 0);
+	dsp_wakeup    = host_sem_create();
+	dsp_caught_up = host_sem_create();
+	dsp_thread = host_thread_create(DSP_Thread, "[DSP] DSP56001", NULL);
+	Log_Printf(LOG_WARN, "[DSP] Using separate thread for DSP, max. skew %d cycles",
+	           ConfigureParams.System.nDSPMaxSkew);
+}
+
+static void DSP_StopThread(void)
+{
+	if (!dsp_thread)
+		return;
+	
+	host_atomic_set(&dsp_thread_quit, 1);
+	host_sem_post(dsp_wakeup);
+	host_thread_wait(dsp_thread);
+	dsp_thread = NULL;
+	host_sem_destroy(dsp_wakeup);
+	host_sem_destroy(dsp_caught_up);
+	DSP_UpdateHostInterrupt();
+}
+#endif
+
+
 /**
  * Initialize the DSP emulation
  */
@@ -214,6 +426,7 @@ void DSP_UnInit(void)
 #if ENABLE_DSP_EMU
 	if (!bDspEnabled)
 		return;
+	DSP_StopThread();
 	dsp_core_shutdown();
 	bDspEnabled = false;
 #endif
@@ -239,7 +452,22 @@ void DSP_Reset(void)
 	}
 	Statusbar_SetDspLed(false);
 
-	dsp_core_reset();
+	if (bDspEmulated && ConfigureParams.System.bDSPThread) {
+		DSP_StartThread();
+	} else {
+		DSP_StopThread();
+	}
+	
+	if (dsp_thread) {
+		host_lock(&dsp_lock);
+		dsp_core_reset();
+		host_atomic_set(&dsp_cycles, 0);
+		host_atomic_set(&dsp_break, 0);
+		host_unlock(&dsp_lock);
+		DSP_UpdateHostInterrupt();
+	} else {
+		dsp_core_reset();
+	}
 	save_cycles = 0;
 #endif
 }
@@ -254,7 +482,15 @@ void DSP_Start(Uint8 mode)
 		return;
 	}
 #if ENABLE_DSP_EMU
-    dsp_core_start(mode);
+	if (dsp_thread) {
+		host_lock(&dsp_lock);
+		dsp_core_start(mode);
+		host_atomic_set(&dsp_cycles, 0);
+		host_unlock(&dsp_lock);
+		DSP_UpdateHostInterrupt();
+	} else {
+		dsp_core_start(mode);
+	}
     save_cycles = 0;
 #endif
 }
@@ -265,6 +501,33 @@ void DSP_Start(Uint8 mode)
 void DSP_Run(int nHostCycles)
 {
 #if ENABLE_DSP_EMU
+	if (dsp_thread) {
+		/* Grant cycles to DSP thread and wait if it is too far behind */
+		int grant = nHostCycles * 2;
+		int old = host_atomic_add(&dsp_cycles, grant);
+		if (old <= 0) {
+			DSP_WakeThread();
+		}
+		if (old + grant > ConfigureParams.System.nDSPMaxSkew) {
+			DSP_WaitThread();
+		}
+		DSP_UpdateHostInterrupt();
+		
+		if (host_atomic_get(&dsp_break)) {
+			DebugUI(REASON_DSP_EXCEPTION);
+			host_atomic_set(&dsp_break, 0);
+			DSP_WakeThread();
+		}
+		
+		if (dsp_core.dma_mode && dsp_core.dma_request) {
+			host_lock(&dsp_lock);
+			DSP_HandleDMA();
+			host_unlock(&dsp_lock);
+			DSP_UpdateHostInterrupt();
+		}
+		return;
+	}
+	
 	save_cycles += nHostCycles * 2;
 	
 	while (save_cycles > 0)
@@ -277,6 +540,38 @@ void DSP_Run(int nHostCycles)
 #endif
 }
 
+/**
+ * Enter the debugger on a DSP exception. The debugger has to run on the
+ * m68k thread, so with the DSP thread the request is deferred to DSP_Run().
+ */
+void DSP_DebugException(void)
+{
+#if ENABLE_DSP_EMU
+	if (dsp_thread) {
+		host_atomic_set(&dsp_break, 1);
+		return;
+	}
+#endif
+	DebugUI(REASON_DSP_EXCEPTION);
+}
+
+/**
+ * Keep the DSP thread from changing dsp_core while the debugger accesses it
+ */
+#if ENABLE_DSP_EMU
+static void DSP_DebugLock(void)
+{
+	if (dsp_thread)
+		host_lock(&dsp_lock);
+}
+
+static void DSP_DebugUnlock(void)
+{
+	if (dsp_thread)
+		host_unlock(&dsp_lock);
+}
+#endif
+
 /**
  * Enable/disable DSP debugging mode
  */
@@ -285,15 +580,41 @@ void DSP_SetDebugging(bool enabled)
 	bDspDebugging = enabled;
 }
 
+
+/**
+ * Save/Restore snapshot of DSP state
+ */
+void DSP_MemorySnapShot_Capture(bool bSave)
+{
+#if ENABLE_DSP_EMU
+	if (dsp_thread) {
+		host_lock(&dsp_lock);
+		MemorySnapShot_Store(&dsp_core, sizeof(dsp_core));
+		host_atomic_set(&dsp_cycles, 0);
+		host_unlock(&dsp_lock);
+		DSP_UpdateHostInterrupt();
+	} else {
+		MemorySnapShot_Store(&dsp_core, sizeof(dsp_core));
+	}
+	MemorySnapShot_Store(&save_cycles, sizeof(save_cycles));
+#endif
+	MemorySnapShot_Store(&bDspHostInterruptPending, sizeof(bDspHostInterruptPending));
+}
+
 /**
  * Get DSP program counter (for debugging)
  */
 Uint16 DSP_GetPC(void)
 {
 #if ENABLE_DSP_EMU
-	if (bDspEnabled)
-		return dsp_core.pc;
-	else
+	Uint16 pc;
+
+	if (bDspEnabled) {
+		DSP_DebugLock();
+		pc = dsp_core.pc;
+		DSP_DebugUnlock();
+		return pc;
+	}
 #endif
 	return 0;
 }
@@ -312,6 +633,7 @@ Uint16 DSP_GetNextPC(Uint16 pc)
 		return 0;
 
 	/* Save DSP context */
+	DSP_DebugLock();
 	memcpy(&dsp_core_save, &dsp_core, sizeof(dsp_core));
 
 	/* Disasm instruction */
@@ -323,6 +645,7 @@ Uint16 DSP_GetNextPC(Uint16 pc)
 
 	/* Restore DSP context */
 	memcpy(&dsp_core, &dsp_core_save, sizeof(dsp_core));
+	DSP_DebugUnlock();
 
 	return pc + instruction_length;
 #else
@@ -336,9 +659,14 @@ Uint16 DSP_GetNextPC(Uint16 pc)
 Uint16 DSP_GetInstrCycles(void)
 {
 #if ENABLE_DSP_EMU
-	if (bDspEnabled)
-		return dsp_core.instr_cycle;
-	else
+	Uint16 cycles;
+
+	if (bDspEnabled) {
+		DSP_DebugLock();
+		cycles = dsp_core.instr_cycle;
+		DSP_DebugUnlock();
+		return cycles;
+	}
 #endif
 	return 0;
 }
@@ -352,9 +680,11 @@ Uint16 DSP_DisasmAddress(FILE *out, Uint16 lowerAdr, Uint16 UpperAdr)
 #if ENABLE_DSP_EMU
 	Uint16 dsp_pc;
 
+	DSP_DebugLock();
 	for (dsp_pc=lowerAdr; dsp_pc<=UpperAdr; dsp_pc++) {
 		dsp_pc += dsp56k_execute_one_disasm_instruction(out, dsp_pc);
 	}
+	DSP_DebugUnlock();
 	return dsp_pc;
 #else
 	return 0;
@@ -371,9 +701,9 @@ Uint16 DSP_DisasmAddress(FILE *out, Uint16 lowerAdr, Uint16 UpperAdr)
  * Return the value at given address. For valid values AND the return
  * value with BITMASK(24).
  */
-Uint32 DSP_ReadMemory(Uint16 address, char space_id, const char **mem_str)
-{
 #if ENABLE_DSP_EMU
+static Uint32 DSP_ReadMemoryUnlocked(Uint16 address, char space_id, const char **mem_str)
+{
 	static const char *spaces[3][4] = {
 		{ "X ram", "X rom", "X", "X periph" },
 		{ "Y ram", "Y rom", "Y", "Y periph" },
@@ -443,8 +773,21 @@ Uint32 DSP_ReadMemory(Uint16 address, char space_id, const char **mem_str)
 	/* Falcon: External RAM, finally map X,Y to P */
 	*mem_str = spaces[idx][2];
 	return dsp_core.ramext[address & (DSP_RAMSIZE-1)];
+}
 #endif
+
+Uint32 DSP_ReadMemory(Uint16 address, char space_id, const char **mem_str)
+{
+#if ENABLE_DSP_EMU
+	Uint32 value;
+
+	DSP_DebugLock();
+	value = DSP_ReadMemoryUnlocked(address, space_id, mem_str);
+	DSP_DebugUnlock();
+	return value;
+#else
 	return 0;
+#endif
 }
 
 
@@ -458,6 +801,7 @@ Uint16 DSP_DisasmMemory(Uint16 dsp_memdump_addr, Uint16 dsp_memdump_upper, char
 	Uint32 mem, mem2, value;
 	const char *mem_str;
 
+	DSP_DebugLock();
 	for (mem = dsp_memdump_addr; mem <= dsp_memdump_upper; mem++) {
 		/* special printing of host communication/transmit registers */
 		if (space == 'X' && mem >= 0xffc0) {
@@ -470,7 +814,7 @@ Uint16 DSP_DisasmMemory(Uint16 dsp_memdump_addr, Uint16 dsp_memdump_upper, char
 					mem, dsp_core.ssi.transmit_value, dsp_core.ssi.received_value);
 			}
 			else {
-				value = DSP_ReadMemory(mem, space, &mem_str);
+				value = DSP_ReadMemoryUnlocked(mem, space, &mem_str);
 				fprintf(stderr,"%s:%04x  %06x\t%s\n", mem_str, mem, value, x_ext_memory_addr_name[mem-0xffc0]);
 			}
 			continue;
@@ -486,9 +830,10 @@ Uint16 DSP_DisasmMemory(Uint16 dsp_memdump_addr, Uint16 dsp_memdump_upper, char
 				mem, mem2, dsp_core.ramext[mem2 & (DSP_RAMSIZE-1)]);
 			continue;
 		}
-		value = DSP_ReadMemory(mem, space, &mem_str);
+		value = DSP_ReadMemoryUnlocked(mem, space, &mem_str);
 		fprintf(stderr,"%s:%04x  %06x\n", mem_str, mem, value);
 	}
+	DSP_DebugUnlock();
 #endif
 	return dsp_memdump_upper+1;
 }
@@ -505,6 +850,8 @@ void DSP_Info(Uint32 dummy)
 
 	fputs("DSP core information:\n", stderr);
 
+	DSP_DebugLock();
+
 	for (i = 0; i < ARRAYSIZE(stackname); i++) {
 		fprintf(stderr, "- %s stack:", stackname[i]);
 		for (j = 0; j < ARRAYSIZE(dsp_core.stack[0]); j++) {
@@ -535,6 +882,7 @@ void DSP_Info(Uint32 dummy)
 		fprintf(stderr, " %02x", dsp_core.hostport[i]);
 	}
 	fputs("\n", stderr);
+	DSP_DebugUnlock();
 #endif
 }
 
@@ -546,6 +894,7 @@ void DSP_DisasmRegisters(void)
 #if ENABLE_DSP_EMU
 	Uint32 i;
 
+	DSP_DebugLock();
 	fprintf(stderr,"A: A2: %02x  A1: %06x  A0: %06x\n",
 		dsp_core.registers[DSP_REG_A2], dsp_core.registers[DSP_REG_A1], dsp_core.registers[DSP_REG_A0]);
 	fprintf(stderr,"B: B2: %02x  B1: %06x  B0: %06x\n",
@@ -565,6 +914,7 @@ void DSP_DisasmRegisters(void)
 	fprintf(stderr,"SR: %04x  OMR: %02x\n", dsp_core.registers[DSP_REG_SR], dsp_core.registers[DSP_REG_OMR]);
 	fprintf(stderr,"SP: %02x    SSH: %04x  SSL: %04x\n", 
 		dsp_core.registers[DSP_REG_SP], dsp_core.registers[DSP_REG_SSH], dsp_core.registers[DSP_REG_SSL]);
+	DSP_DebugUnlock();
 #endif
 }
 
@@ -703,9 +1053,9 @@ int DSP_GetRegisterAddress(const char *regname, Uint32 **addr, Uint32 *mask)
 /**
  * Set given DSP register value, return false if unknown register given
  */
-bool DSP_Disasm_SetRegister(const char *arg, Uint32 value)
-{
 #if ENABLE_DSP_EMU
+static bool DSP_SetRegisterUnlocked(const char *arg, Uint32 value)
+{
 	Uint32 *addr, mask, sp_value;
 	int bits;
 
@@ -753,8 +1103,22 @@ bool DSP_Disasm_SetRegister(const char *arg, Uint32 value)
 		*(Uint16*)addr = value & mask;
 		return true;
 	}
+	return false;
+}
 #endif
+
+bool DSP_Disasm_SetRegister(const char *arg, Uint32 value)
+{
+#if ENABLE_DSP_EMU
+	bool ok;
+
+	DSP_DebugLock();
+	ok = DSP_SetRegisterUnlocked(arg, value);
+	DSP_DebugUnlock();
+	return ok;
+#else
 	return false;
+#endif
 }
 
 /**
@@ -851,7 +1215,7 @@ void DSP_HandleReadAccess(void)
 	for (addr = IoAccessBaseAddress; addr < IoAccessBaseAddress+nIoMemAccessSize; addr++)
 	{
 #if ENABLE_DSP_EMU
-		value = dsp_core_read_host(addr-DSP_HW_OFFSET);
+		value = DSP_ReadHost(addr-DSP_HW_OFFSET);
 #else
 		/* this value prevents TOS from hanging in the DSP init code */
 		value = 0xff;
@@ -880,7 +1244,7 @@ void DSP_HandleWriteAccess(void)
 #if ENABLE_DSP_EMU
 		Uint8 value = IoMem_ReadByte(addr);
 		Dprintf(("HWput_b(0x%08x,0x%02x) at 0x%08x\n", addr, value, m68k_getpc()));
-		dsp_core_write_host(addr-DSP_HW_OFFSET, value);
+		DSP_WriteHost(addr-DSP_HW_OFFSET, value);
 #endif
 		if (multi_access == true)
 			M68000_AddCycles(4);
@@ -920,7 +1284,7 @@ void DSP_HandleWriteAccess(void)
 void DSP_ICR_Read(void) { // 0x02008000
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_ICR);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_ICR);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0x7F;
 #else
@@ -932,7 +1296,7 @@ void DSP_ICR_Read(void) { // 0x02008000
 void DSP_ICR_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_ICR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_ICR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] ICR write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -940,7 +1304,7 @@ void DSP_ICR_Write(void) {
 void DSP_CVR_Read(void) { // 0x02008001
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_CVR);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_CVR);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0xFF;
 #else
@@ -952,7 +1316,7 @@ void DSP_CVR_Read(void) { // 0x02008001
 void DSP_CVR_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_CVR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_CVR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] CVR write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -960,7 +1324,7 @@ void DSP_CVR_Write(void) {
 void DSP_ISR_Read(void) { // 0x02008002
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_ISR);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_ISR);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0xFF;
 #else
@@ -972,7 +1336,7 @@ void DSP_ISR_Read(void) { // 0x02008002
 void DSP_ISR_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_ISR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_ISR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] ISR write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -980,7 +1344,7 @@ void DSP_ISR_Write(void) {
 void DSP_IVR_Read(void) { // 0x02008003
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_IVR);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_IVR);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0xFF;
 #else
@@ -992,7 +1356,7 @@ void DSP_IVR_Read(void) { // 0x02008003
 void DSP_IVR_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_IVR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_IVR, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] IVR write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -1000,7 +1364,7 @@ void DSP_IVR_Write(void) {
 void DSP_Data0_Read(void) { // 0x02008004
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_TRX0);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_TRX0);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0x00;
 #else
@@ -1012,7 +1376,7 @@ void DSP_Data0_Read(void) { // 0x02008004
 void DSP_Data0_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_TRX0, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_TRX0, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] Data0 write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -1020,7 +1384,7 @@ void DSP_Data0_Write(void) {
 void DSP_Data1_Read(void) { // 0x02008005
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_TRXH);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_TRXH);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0x00;
 #else
@@ -1032,7 +1396,7 @@ void DSP_Data1_Read(void) { // 0x02008005
 void DSP_Data1_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_TRXH, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_TRXH, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] Data1 write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -1040,7 +1404,7 @@ void DSP_Data1_Write(void) {
 void DSP_Data2_Read(void) { // 0x02008006
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_TRXM);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_TRXM);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0x00;
 #else
@@ -1052,7 +1416,7 @@ void DSP_Data2_Read(void) { // 0x02008006
 void DSP_Data2_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_TRXM, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_TRXM, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] Data2 write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -1060,7 +1424,7 @@ void DSP_Data2_Write(void) {
 void DSP_Data3_Read(void) { // 0x02008007
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = dsp_core_read_host(CPU_HOST_TRXL);
+		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = DSP_ReadHost(CPU_HOST_TRXL);
 	else
 		IoMem[IoAccessCurrentAddress & IO_SEG_MASK] = 0x00;
 #else
@@ -1072,7 +1436,7 @@ void DSP_Data3_Read(void) { // 0x02008007
 void DSP_Data3_Write(void) {
 #if ENABLE_DSP_EMU
 	if (bDspEmulated)
-		dsp_core_write_host(CPU_HOST_TRXL, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
+		DSP_WriteHost(CPU_HOST_TRXL, IoMem[IoAccessCurrentAddress & IO_SEG_MASK]);
 #endif
     Log_Printf(LOG_DSP_REG_LEVEL,"[DSP] Data3 write at $%08x val=$%02x PC=$%08x\n", IoAccessCurrentAddress, IoMem[IoAccessCurrentAddress & IO_SEG_MASK], m68k_getpc());
 }
@@ -47,6 +47,7 @@ extern void DSP_MemorySnapShot_Capture(bool bSave);
 
 /* Dsp Debugger commands */
 extern void DSP_SetDebugging(bool enabled);
+extern void DSP_DebugException(void);
 extern Uint16 DSP_GetPC(void);
 extern Uint16 DSP_GetNextPC(Uint16 pc);
 extern Uint16 DSP_GetInstrCycles(void);
@@ -96,8 +97,8 @@ void DSP_Data2_Write(void);
 void DSP_Data3_Read(void);
 void DSP_Data3_Write(void);
 
-Uint8 dsp_intr_at_block_end;
-Uint8 dsp_dma_unpacked;
+extern Uint8 dsp_intr_at_block_end;
+extern Uint8 dsp_dma_unpacked;
 void DSP_SetIRQB(void);
 
 #endif /* DSP_H */
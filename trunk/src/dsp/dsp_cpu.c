@@ -89,6 +89,7 @@
 #include "dsp_core.h"
 #include "dsp_cpu.h"
 #include "dsp_disasm.h"
+#include "dsp.h"
 #include "log.h"
 #include "debugui.h"
 
@@ -1556,7 +1557,7 @@ static void dsp_write_reg(Uint32 numreg, Uint32 value)
 				if (!isDsp_in_disasm_mode)
 					fprintf(stderr,"Dsp: Stack Overflow or Underflow\n");
 				if (ExceptionDebugMask & EXCEPT_DSP)
-					DebugUI(REASON_DSP_EXCEPTION);
+					DSP_DebugException();
 			}
 			else
 				dsp_core.registers[DSP_REG_SP] = value & BITMASK(6);
@@ -1599,7 +1600,7 @@ static void dsp_stack_push(Uint32 curpc, Uint32 cursr, Uint16 sshOnly)
 		if (!isDsp_in_disasm_mode)
 			fprintf(stderr,"Dsp: Stack Overflow\n");
 		if (ExceptionDebugMask & EXCEPT_DSP)
-			DebugUI(REASON_DSP_EXCEPTION);
+			DSP_DebugException();
 	}
 	
 	dsp_core.registers[DSP_REG_SP] = (underflow | stack_error | stack) & BITMASK(6);
@@ -1636,7 +1637,7 @@ static void dsp_stack_pop(Uint32 *newpc, Uint32 *newsr)
 		if (!isDsp_in_disasm_mode)
 			fprintf(stderr,"Dsp: Stack underflow\n");
 		if (ExceptionDebugMask & EXCEPT_DSP)
-			DebugUI(REASON_DSP_EXCEPTION);
+			DSP_DebugException();
 	}
 
 	dsp_core.registers[DSP_REG_SP] = (underflow | stack_error | stack) & BITMASK(6);
@@ -1954,7 +1955,7 @@ static void dsp_undefined(void)
 		dsp_core.instr_cycle = 0;
 	}
 	if (ExceptionDebugMask & EXCEPT_DSP) {
-		DebugUI(REASON_DSP_EXCEPTION);
+		DSP_DebugException();
 	}
 }
 
@@ -2499,7 +2500,7 @@ static void dsp_illegal(void)
 	/* Raise interrupt p:0x003e */
 	dsp_set_interrupt(DSP_INTER_ILLEGAL, 1);
 	if (ExceptionDebugMask & EXCEPT_DSP) {
-		DebugUI(REASON_DSP_EXCEPTION);
+		DSP_DebugException();
 	}
 }
 
@@ -10,6 +10,7 @@
 #include "sysReg.h"
 #include "dma.h"
 #include "scsi.h"
+#include "memorySnapShot.h"
 
 #define LOG_ESPDMA_LEVEL    LOG_DEBUG   /* Print debugging messages for ESP DMA registers */
 #define LOG_ESPCMD_LEVEL    LOG_DEBUG   /* Print debugging messages for ESP commands */
@@ -751,6 +752,36 @@ enum {
     ESP_IO_STATE_DONE
 } esp_io_state;
 
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of ESP variables ('MemorySnapShot_Store' handles type)
+ */
+void ESP_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(&esp_dma, sizeof(esp_dma));
+    MemorySnapShot_Store(&esp_state, sizeof(esp_state));
+    MemorySnapShot_Store(&esp_cmd_state, sizeof(esp_cmd_state));
+    MemorySnapShot_Store(&writetranscountl, sizeof(writetranscountl));
+    MemorySnapShot_Store(&writetranscounth, sizeof(writetranscounth));
+    MemorySnapShot_Store(fifo, sizeof(fifo));
+    MemorySnapShot_Store(command, sizeof(command));
+    MemorySnapShot_Store(&status, sizeof(status));
+    MemorySnapShot_Store(&selectbusid, sizeof(selectbusid));
+    MemorySnapShot_Store(&intstatus, sizeof(intstatus));
+    MemorySnapShot_Store(&selecttimeout, sizeof(selecttimeout));
+    MemorySnapShot_Store(&seqstep, sizeof(seqstep));
+    MemorySnapShot_Store(&syncperiod, sizeof(syncperiod));
+    MemorySnapShot_Store(&fifoflags, sizeof(fifoflags));
+    MemorySnapShot_Store(&syncoffset, sizeof(syncoffset));
+    MemorySnapShot_Store(&configuration, sizeof(configuration));
+    MemorySnapShot_Store(&clockconv, sizeof(clockconv));
+    MemorySnapShot_Store(&esptest, sizeof(esptest));
+    MemorySnapShot_Store(&esp_counter, sizeof(esp_counter));
+    MemorySnapShot_Store(&mode_dma, sizeof(mode_dma));
+    MemorySnapShot_Store(&esp_io_state, sizeof(esp_io_state));
+}
+
 bool esp_transfer_done(bool write) {
     Log_Printf(LOG_ESPCMD_LEVEL, "[ESP] Transfer done: ESP counter = %i, SCSI residual bytes: %i",
                esp_counter,scsi_buffer.size);
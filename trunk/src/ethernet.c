@@ -19,6 +19,7 @@
 #include "enet_pcap.h"
 #include "cycInt.h"
 #include "statusbar.h"
+#include "memorySnapShot.h"
 
 
 #define LOG_EN_LEVEL        LOG_DEBUG
@@ -792,3 +793,20 @@ void Ethernet_Reset(bool hard) {
         enet_stop();
     }
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of ethernet variables ('MemorySnapShot_Store' handles type)
+ */
+void Ethernet_MemorySnapShot_Capture(bool bSave) {
+    MemorySnapShot_Store(&enet, sizeof(enet));
+    MemorySnapShot_Store(&enet_stopped, sizeof(enet_stopped));
+    MemorySnapShot_Store(&receiver_state, sizeof(receiver_state));
+    MemorySnapShot_Store(&tx_done, sizeof(tx_done));
+    MemorySnapShot_Store(&rx_chain, sizeof(rx_chain));
+    MemorySnapShot_Store(&old_size, sizeof(old_size));
+    MemorySnapShot_Store(&en_state, sizeof(en_state));
+    MemorySnapShot_Store(&enet_tx_buffer, sizeof(enet_tx_buffer));
+    MemorySnapShot_Store(&enet_rx_buffer, sizeof(enet_rx_buffer));
+}
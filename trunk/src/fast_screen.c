@@ -21,8 +21,14 @@ const char Screen_fileid[] = "Previous fast_screen.c : " __DATE__ " " __TIME__;
 #include "nd_mem.hpp"
 #include "paths.h"
 #include "screen.h"
+#include "screen_convert.h"
 #include "statusbar.h"
 #include "video.h"
+#include "file.h"
+
+#if HAVE_LIBPNG
+#include <png.h>
+#endif
 
 SDL_Window*   sdlWindow;
 SDL_Surface*  sdlscrn = NULL;   /* The SDL screen surface */
@@ -40,80 +46,114 @@ static SDL_Renderer* sdlRenderer;
 static SDL_sem*      initLatch;
 static SDL_atomic_t  blitFB;
 static SDL_atomic_t  blitUI;           /* When value == 1, the repaint thread will blit the sldscrn surface to the screen on the next redraw */
-static bool          doUIblit;
 static SDL_Rect      saveWindowBounds; /* Window bounds before going fullscreen. Used to restore window size & position. */
 static void*         uiBuffer;         /* uiBuffer used for ui texture */
 static void*         uiBufferTmp;      /* Temporary uiBuffer used by repainter */
+static Uint32*       fbBuffer;         /* Converted NeXT framebuffer lines used by repainter */
+static int           fbMonitorType = -1; /* Monitor type of the last blit, used by repainter */
+static SDL_atomic_t  forcePresent;     /* When value == 1, the repainter presents even if nothing changed */
 static SDL_SpinLock  uiBufferLock;     /* Lock for concurrent access to UI buffer between m68k thread and repainter */
 static Uint32        mask;             /* green screen mask for transparent UI areas */
 static volatile bool doRepaint  = true; /* Repaint thread runs while true */
 static SDL_Rect      statusBar;
+static SDL_Rect      uiDirty;          /* Area of uiBuffer not yet uploaded by the repainter, guarded by uiBufferLock */
 
 
-static Uint32 BW2RGB[0x400];
-static Uint32 COL2RGB[0x10000];
+static SDL_PixelFormat* fbFormat;      /* Pixel format of the framebuffer texture */
 
-static Uint32 bw2rgb(SDL_PixelFormat* format, int bw) {
-    switch(bw & 3) {
-        case 3:  return SDL_MapRGB(format, 0,   0,   0);
-        case 2:  return SDL_MapRGB(format, 85,  85,  85);
-        case 1:  return SDL_MapRGB(format, 170, 170, 170);
-        case 0:  return SDL_MapRGB(format, 255, 255, 255);
-        default: return 0;
+/*
+ BW format is 2bit per pixel
+ */
+static void convertBWLines(Uint32* dst, int first, int last) {
+    int   pitch = (NeXT_SCRN_WIDTH + (ConfigureParams.System.bTurbo ? 0 : 32)) / 4;
+    for(int y = first; y < last; y++, dst += NeXT_SCRN_WIDTH) {
+        Convert_BW(dst, &NEXTVideo[y * pitch], NeXT_SCRN_WIDTH/4);
     }
 }
 
-static Uint32 col2rgb(SDL_PixelFormat* format, int col) {
-    int r = col & 0xF000; r >>= 12; r |= r << 4;
-    int g = col & 0x0F00; g >>= 8;  g |= g << 4;
-    int b = col & 0x00F0; b >>= 4;  b |= b << 4;
-    return SDL_MapRGB(format, r,   g,   b);
+static void convertBW(Uint32* dst) {
+    convertBWLines(dst, 0, NeXT_SCRN_HEIGHT);
 }
 
 /*
- BW format is 2bit per pixel
+ Color format is 4bit per pixel, big-endian: RGBx
  */
-static void blitBW(SDL_Texture* tex) {
-    void* pixels;
-    int   d;
-    int   pitch = (NeXT_SCRN_WIDTH + (ConfigureParams.System.bTurbo ? 0 : 32)) / 4;
-    SDL_LockTexture(tex, NULL, &pixels, &d);
-    Uint32* dst = (Uint32*)pixels;
-    for(int y = 0; y < NeXT_SCRN_HEIGHT; y++) {
-        int src     = y * pitch;
-        for(int x = 0; x < NeXT_SCRN_WIDTH/4; x++, src++) {
-            int idx = NEXTVideo[src] * 4;
-            *dst++  = BW2RGB[idx+0];
-            *dst++  = BW2RGB[idx+1];
-            *dst++  = BW2RGB[idx+2];
-            *dst++  = BW2RGB[idx+3];
-        }
+static void convertColorLines(Uint32* dst, int first, int last) {
+    int pitch = (NeXT_SCRN_WIDTH + (ConfigureParams.System.bTurbo ? 0 : 32)) * 2;
+    for(int y = first; y < last; y++, dst += NeXT_SCRN_WIDTH) {
+        Convert_Color(dst, &NEXTVideo[y * pitch], NeXT_SCRN_WIDTH);
     }
-    SDL_UnlockTexture(tex);
+}
+
+static void convertColor(Uint32* dst) {
+    convertColorLines(dst, 0, NeXT_SCRN_HEIGHT);
 }
 
 /*
- Color format is 4bit per pixel, big-endian: RGBx
+ Convert the dirty scanlines (all lines if all is true) of the NeXT
+ framebuffer and upload them to the texture, one rectangle per run of
+ consecutive dirty lines. Returns false if no line changed since the last call.
  */
-static void blitColor(SDL_Texture* tex) {
-    void* pixels;
-    int   d;
-    int pitch = NeXT_SCRN_WIDTH + (ConfigureParams.System.bTurbo ? 0 : 32);
-    SDL_LockTexture(tex, NULL, &pixels, &d);
-    Uint32* dst = (Uint32*)pixels;
-    for(int y = 0; y < NeXT_SCRN_HEIGHT; y++) {
-        Uint16* src = (Uint16*)NEXTVideo + (y*pitch);
-        for(int x = 0; x < NeXT_SCRN_WIDTH; x++) {
-            *dst++ = COL2RGB[*src++];
+static bool blitDirtyLines(SDL_Texture* tex, bool all) {
+    Uint32   dirty[NEXT_VIDEO_DIRTY_WORDS];
+    SDL_Rect rect = { 0, 0, NeXT_SCRN_WIDTH, 0 };
+    bool     color = ConfigureParams.System.bColor;
+    
+    if (!memory_video_get_dirty(dirty) && !all)
+        return false;
+    if (all)
+        memset(dirty, 0xFF, sizeof(dirty));
+    
+    for (int y = 0; y < NeXT_SCRN_HEIGHT;) {
+        if (!(dirty[y >> 5] & (1u << (y & 31)))) {
+            y++;
+            continue;
         }
+        int first = y;
+        while (y < NeXT_SCRN_HEIGHT && (dirty[y >> 5] & (1u << (y & 31))))
+            y++;
+        
+        Uint32* dst = &fbBuffer[first * NeXT_SCRN_WIDTH];
+        if (color) {
+            convertColorLines(dst, first, y);
+        } else {
+            convertBWLines(dst, first, y);
+        }
+        rect.y = first;
+        rect.h = y - first;
+        SDL_UpdateTexture(tex, &rect, dst, NeXT_SCRN_WIDTH * sizeof(Uint32));
     }
-    SDL_UnlockTexture(tex);
+    return true;
 }
 
 /*
  Dimension format is 8bit per pixel, big-endian: RRGGBBAA
  */
-void blitDimension(Uint32* vram, SDL_Texture* tex) {
+static void blitDimensionLines(Uint32* src, SDL_Texture* tex, convert_format_t* f, int first, int last) {
+    SDL_Rect rect = { 0, first, NeXT_SCRN_WIDTH, last - first };
+    src += first * (NeXT_SCRN_WIDTH + 32);
+    if(SDL_BYTEORDER == SDL_LIL_ENDIAN && f->format == SDL_PIXELFORMAT_ARGB8888) {
+        /* VRAM pixels are already in texture format */
+        SDL_UpdateTexture(tex, &rect, src, (NeXT_SCRN_WIDTH+32)*4);
+    } else {
+        void*   pixels;
+        int     pitch;
+        SDL_LockTexture(tex, &rect, &pixels, &pitch);
+        Uint8* dst = (Uint8*)pixels;
+        for(int y = first; y < last; y++) {
+            Convert_Dimension(f, (Uint32*)dst, src, NeXT_SCRN_WIDTH);
+            dst += pitch;
+            src += NeXT_SCRN_WIDTH + 32;
+        }
+        SDL_UnlockTexture(tex);
+    }
+}
+
+/*
+ Upload the given dirty scanlines (all lines if dirty is NULL) of a
+ NeXTdimension framebuffer to the texture.
+ */
+void blitDimension(Uint32* vram, SDL_Texture* tex, const Uint32* dirty) {
 #if ND_STEP
     Uint32* src = &vram[0];
 #else
@@ -121,74 +161,91 @@ void blitDimension(Uint32* vram, SDL_Texture* tex) {
 #endif
     int     d;
     Uint32  format;
+    convert_format_t f;
     SDL_QueryTexture(tex, &format, &d, &d, &d);
-    if(SDL_BYTEORDER == SDL_BIG_ENDIAN) {
-        /* Add big-endian accelerated blit loops as needed here */
-        switch (format) {
-            default: {
-                void*   pixels;
-                SDL_LockTexture(tex, NULL, &pixels, &d);
-                Uint32* dst = (Uint32*)pixels;
-
-                /* fallback to SDL_MapRGB */
-                SDL_PixelFormat* pformat = SDL_AllocFormat(format);
-                for(int y = NeXT_SCRN_HEIGHT; --y >= 0;) {
-                    for(int x = NeXT_SCRN_WIDTH; --x >= 0;) {
-                        Uint32 v = *src++;
-                        *dst++   = SDL_MapRGB(pformat, (v >> 8) & 0xFF, (v>>16) & 0xFF, (v>>24) & 0xFF);
-                    }
-                    src += 32;
-                }
-                SDL_FreeFormat(pformat);
-                SDL_UnlockTexture(tex);
-                break;
-            }
-        }
+    Convert_SetFormat(&f, format);
+    if (!dirty) {
+        blitDimensionLines(src, tex, &f, 0, NeXT_SCRN_HEIGHT);
     } else {
-        /* Add little-endian accelerated blit loops as needed here */
-        switch (format) {
-            case SDL_PIXELFORMAT_ARGB8888: {
-                SDL_UpdateTexture(tex, NULL, src, (NeXT_SCRN_WIDTH+32)*4);
-                break;
-            }
-            default: {
-                void*   pixels;
-                SDL_LockTexture(tex, NULL, &pixels, &d);
-                Uint32* dst = (Uint32*)pixels;
-
-                /* fallback to SDL_MapRGB */
-                SDL_PixelFormat* pformat = SDL_AllocFormat(format);
-                for(int y = NeXT_SCRN_HEIGHT; --y >= 0;) {
-                    for(int x = NeXT_SCRN_WIDTH; --x >= 0;) {
-                        Uint32 v = *src++;
-                        *dst++   = SDL_MapRGB(pformat, (v >> 16) & 0xFF, (v>>8) & 0xFF, (v>>0) & 0xFF);
-                    }
-                    src += 32;
-                }
-                SDL_FreeFormat(pformat);
-                SDL_UnlockTexture(tex);
-                break;
+        for (int y = 0; y < NeXT_SCRN_HEIGHT;) {
+            if (!(dirty[y >> 5] & (1u << (y & 31)))) {
+                y++;
+                continue;
             }
+            int first = y;
+            while (y < NeXT_SCRN_HEIGHT && (dirty[y >> 5] & (1u << (y & 31))))
+                y++;
+            blitDimensionLines(src, tex, &f, first, y);
         }
     }
+    Convert_FreeFormat(&f);
 }
 
 /*
- Blit NeXT framebuffer to texture.
+ Blit NeXT framebuffer to texture. Returns false if nothing changed.
  */
-static void blitScreen(SDL_Texture* tex) {
+static bool blitScreen(SDL_Texture* tex) {
+    /* texture was written for another monitor, convert all lines */
+    bool all = fbMonitorType != ConfigureParams.Screen.nMonitorType;
+    fbMonitorType = ConfigureParams.Screen.nMonitorType;
+    
     if (ConfigureParams.Screen.nMonitorType==MONITOR_TYPE_DIMENSION) {
-        Uint32* vram = nd_vram_for_slot(ND_SLOT(ConfigureParams.Screen.nMonitorNum));
-        if(vram) blitDimension(vram, tex);
-        return;
+        int     slot = ND_SLOT(ConfigureParams.Screen.nMonitorNum);
+        Uint32* vram = nd_vram_for_slot(slot);
+        Uint32  dirty[ND_DIRTY_WORDS];
+        if(vram && (nd_vram_get_dirty(slot, dirty) || all)) {
+            blitDimension(vram, tex, all ? NULL : dirty);
+            return true;
+        }
+        return false;
     }
     if(NEXTVideo) {
-        if(ConfigureParams.System.bColor) {
-            blitColor(tex);
-        } else {
-            blitBW(tex);
-        }
+        return blitDirtyLines(tex, all);
     }
+    return false;
+}
+
+/*
+ Creates the UI surface and buffers and sets up lookup tables for the
+ given pixel format.
+ */
+static void initSurface(Uint32 format, int width, int height) {
+    Uint32 r, g, b, a;
+    int    d;
+    
+    statusBar.x = 0;
+    statusBar.y = NeXT_SCRN_HEIGHT;
+    statusBar.w = width;
+    statusBar.h = height - NeXT_SCRN_HEIGHT;
+    
+    SDL_PixelFormatEnumToMasks(format, &d, &r, &g, &b, &a);
+    mask = g | a;
+    sdlscrn     = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, r, g, b, a);
+    
+    /* Exit if we can not open a screen */
+    if (!sdlscrn) {
+        fprintf(stderr, "Could not set video mode:\n %s\n", SDL_GetError() );
+        SDL_Quit();
+        exit(-2);
+    }
+    
+    /* start with a transparent UI, uploaded completely on the first frame */
+    uiBuffer    = calloc(sdlscrn->h, sdlscrn->pitch);
+    uiBufferTmp = calloc(sdlscrn->h, sdlscrn->pitch);
+    uiDirty.x   = 0;
+    uiDirty.y   = 0;
+    uiDirty.w   = width;
+    uiDirty.h   = height;
+    SDL_AtomicSet(&blitUI, 1);
+    fbBuffer    = malloc(NeXT_SCRN_WIDTH * NeXT_SCRN_HEIGHT * sizeof(Uint32));
+    // clear UI with mask
+    SDL_FillRect(sdlscrn, NULL, mask);
+    
+    Statusbar_Init(sdlscrn);
+    
+    /* Setup conversion kernels and lookup tables */
+    fbFormat = SDL_AllocFormat(format);
+    Convert_Init(format);
 }
 
 /*
@@ -203,16 +260,9 @@ static int repainter(void* unused) {
     SDL_SetThreadPriority(SDL_THREAD_PRIORITY_NORMAL);
     SDL_GetWindowSize(sdlWindow, &width, &height);
     
-    statusBar.x = 0;
-    statusBar.y = NeXT_SCRN_HEIGHT;
-    statusBar.w = width;
-    statusBar.h = height - NeXT_SCRN_HEIGHT;
-    
     SDL_Texture*  uiTexture;
     SDL_Texture*  fbTexture;
     
-    Uint32 r, g, b, a;
-    
     sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     SDL_RenderSetLogicalSize(sdlRenderer, width, height);
     
@@ -225,22 +275,7 @@ static int repainter(void* unused) {
     Uint32 format;
     int    d;
     SDL_QueryTexture(uiTexture, &format, &d, &d, &d);
-    SDL_PixelFormatEnumToMasks(format, &d, &r, &g, &b, &a);
-    mask = g | a;
-    sdlscrn     = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, r, g, b, a);
-    uiBuffer    = malloc(sdlscrn->h * sdlscrn->pitch);
-    uiBufferTmp = malloc(sdlscrn->h * sdlscrn->pitch);
-    // clear UI with mask
-    SDL_FillRect(sdlscrn, NULL, mask);
-    
-    /* Exit if we can not open a screen */
-    if (!sdlscrn) {
-        fprintf(stderr, "Could not set video mode:\n %s\n", SDL_GetError() );
-        SDL_Quit();
-        exit(-2);
-    }
-    
-    Statusbar_Init(sdlscrn);
+    initSurface(format, width, height);
     
 	if (bGrabMouse) {
 		SDL_SetRelativeMouseMode(SDL_TRUE);
@@ -250,19 +285,6 @@ static int repainter(void* unused) {
 	/* Configure some SDL stuff: */
 	SDL_ShowCursor(SDL_DISABLE);
     
-    /* Setup lookup tables */
-    SDL_PixelFormat* pformat = SDL_AllocFormat(format);
-    /* initialize BW lookup table */
-    for(int i = 0; i < 0x100; i++) {
-        BW2RGB[i*4+0] = bw2rgb(pformat, i>>6);
-        BW2RGB[i*4+1] = bw2rgb(pformat, i>>4);
-        BW2RGB[i*4+2] = bw2rgb(pformat, i>>2);
-        BW2RGB[i*4+3] = bw2rgb(pformat, i>>0);
-    }
-    /* initialize color lookup table */
-    for(int i = 0; i < 0x10000; i++)
-        COL2RGB[SDL_BYTEORDER == SDL_BIG_ENDIAN ? i : SDL_Swap16(i)] = col2rgb(pformat, i);
-    
     /* Initialization done -> signal */
     SDL_SemPost(initLatch);
     
@@ -275,25 +297,32 @@ static int repainter(void* unused) {
         bool updateUI = false;
         
         if (SDL_AtomicGet(&blitFB)) {
-            // Blit the NeXT framebuffer to textrue
-            blitScreen(fbTexture);
+            // Blit the changed lines of the NeXT framebuffer to texture
+            updateFB = blitScreen(fbTexture);
+        }
+        if (SDL_AtomicSet(&forcePresent, 0)) {
             updateFB = true;
         }
         
-        // Copy UI surface to texture
+        // Copy changed area of UI surface to texture
+        SDL_Rect uiRect;
         SDL_AtomicLock(&uiBufferLock);
-        if(SDL_AtomicSet(&blitUI, 0)) {
-            // update full UI texture
-            memcpy(uiBufferTmp, uiBuffer, sdlscrn->h * sdlscrn->pitch);
+        if(SDL_AtomicSet(&blitUI, 0) && uiDirty.w && uiDirty.h) {
+            uiRect = uiDirty;
+            uiDirty.w = uiDirty.h = 0;
+            for (int y = uiRect.y; y < uiRect.y + uiRect.h; y++) {
+                int offset = y * sdlscrn->pitch + uiRect.x * 4;
+                memcpy((Uint8*)uiBufferTmp + offset, (Uint8*)uiBuffer + offset, uiRect.w * 4);
+            }
             updateUI = true;
         }
         SDL_AtomicUnlock(&uiBufferLock);
         
         if(updateUI) {
-            SDL_UpdateTexture(uiTexture, NULL, uiBufferTmp, sdlscrn->pitch);
+            SDL_UpdateTexture(uiTexture, &uiRect, (Uint8*)uiBufferTmp + uiRect.y * sdlscrn->pitch + uiRect.x * 4, sdlscrn->pitch);
         }
         
-        // Update and render UI texture
+        // Update and render UI texture, skip presenting if nothing changed
         if (updateFB || updateUI) {
             SDL_RenderClear(sdlRenderer);
             // Render NeXT framebuffer texture
@@ -317,9 +346,20 @@ void Screen_Pause(bool pause) {
         SDL_AtomicSet(&blitFB, 0);
     } else {
         SDL_AtomicSet(&blitFB, 1);
+        SDL_AtomicSet(&forcePresent, 1);
     }
 }
 
+/*-----------------------------------------------------------------------*/
+/**
+ * Refresh Screen, presents the current frame again (e.g. after the window
+ * was exposed) even if the NeXT framebuffer did not change.
+ */
+void Screen_Refresh(void) {
+    SDL_AtomicSet(&forcePresent, 1);
+    nd_sdl_refresh();
+}
+
 /*-----------------------------------------------------------------------*/
 /**
  * Init Screen, creates window and starts repaint thread
@@ -336,6 +376,14 @@ void Screen_Init(void) {
     /* Statusbar height */
     height += Statusbar_SetHeight(width, height);
     
+    /* Headless mode: offscreen surface only, no window and no repainter */
+    if (bHeadless) {
+        fprintf(stderr, "Headless mode: %d x %d offscreen\n", width, height);
+        bInFullScreen = false;
+        initSurface(SDL_PIXELFORMAT_ARGB8888, width, height);
+        return;
+    }
+    
     /* Set new video mode */
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
     
@@ -372,8 +420,10 @@ void nd_sdl_destroy(void);
  */
 void Screen_UnInit(void) {
     doRepaint = false; // stop repaint thread
-    int s;
-    SDL_WaitThread(repaintThread, &s);
+    if (repaintThread) {
+        int s;
+        SDL_WaitThread(repaintThread, &s);
+    }
     nd_sdl_destroy();
 }
 
@@ -384,7 +434,7 @@ void Screen_UnInit(void) {
 void Screen_EnterFullScreen(void) {
 	bool bWasRunning;
 
-	if (!bInFullScreen) {
+	if (!bInFullScreen && sdlWindow) {
 		/* Hold things... */
 		bWasRunning = Main_PauseEmulation(false);
 		bInFullScreen = true;
@@ -393,6 +443,7 @@ void Screen_EnterFullScreen(void) {
         SDL_GetWindowSize(sdlWindow, &saveWindowBounds.w, &saveWindowBounds.h);
         SDL_SetWindowFullscreen(sdlWindow, SDL_WINDOW_FULLSCREEN_DESKTOP);
 		SDL_Delay(20);                  /* To give monitor time to change to new resolution */
+		Screen_Refresh();
 		
 		if (bWasRunning) {
 			/* And off we go... */
@@ -419,6 +470,7 @@ void Screen_ReturnFromFullScreen(void) {
 		SDL_Delay(20);                /* To give monitor time to switch resolution */
         SDL_SetWindowPosition(sdlWindow, saveWindowBounds.x, saveWindowBounds.y);
         SDL_SetWindowSize(sdlWindow, saveWindowBounds.w, saveWindowBounds.h);
+		Screen_Refresh();
         
 		if (bWasRunning) {
 			/* And off we go... */
@@ -438,7 +490,7 @@ void Screen_ReturnFromFullScreen(void) {
  * Force things associated with changing between fullscreen/windowed
  */
 void Screen_ModeChanged(void) {
-	if (!sdlscrn) {
+	if (!sdlscrn || !sdlWindow) {
 		/* screen not yet initialized */
 		return;
 	}
@@ -457,60 +509,85 @@ void Screen_ModeChanged(void) {
  * Draw screen to window/full-screen - (SC) Just status bar updates. Screen redraw is done in repaint thread.
  */
 
-static bool shieldStatusBarUpdate;
+/* Grow dst to include r, an empty dst (w == 0) is replaced */
+static void unionRect(SDL_Rect* dst, const SDL_Rect* r) {
+    if (!dst->w || !dst->h) {
+        *dst = *r;
+    } else {
+        int x2 = SDL_max(dst->x + dst->w, r->x + r->w);
+        int y2 = SDL_max(dst->y + dst->h, r->y + r->h);
+        dst->x = SDL_min(dst->x, r->x);
+        dst->y = SDL_min(dst->y, r->y);
+        dst->w = x2 - dst->x;
+        dst->h = y2 - dst->y;
+    }
+}
 
-static void statusBarUpdate(void) {
-    if(shieldStatusBarUpdate) return;
+/*
+ Copy a rectangle of the UI SDL surface to uiBuffer and mark it for upload
+ by the repainter. Mask pixels above the status bar are replaced with
+ transparent pixels for UI blending with framebuffer texture.
+*/
+static void uiUpdateRect(const SDL_Rect* rect) {
+    SDL_Rect r     = *rect;
+    SDL_Rect whole = { 0, 0, sdlscrn->w, sdlscrn->h };
+    
+    // an empty rectangle updates the whole surface
+    if (!r.w || !r.h) r = whole;
+    if (!SDL_IntersectRect(&r, &whole, &r)) return;
+    
     SDL_LockSurface(sdlscrn);
     SDL_AtomicLock(&uiBufferLock);
-    memcpy(&((Uint8*)uiBuffer)[statusBar.y*sdlscrn->pitch], &((Uint8*)sdlscrn->pixels)[statusBar.y*sdlscrn->pitch], statusBar.h * sdlscrn->pitch);
+    for (int y = r.y; y < r.y + r.h; y++) {
+        Uint32* src = (Uint32*)((Uint8*)sdlscrn->pixels + y * sdlscrn->pitch) + r.x;
+        Uint32* dst = (Uint32*)((Uint8*)uiBuffer        + y * sdlscrn->pitch) + r.x;
+        if (y < statusBar.y) {
+            // poor man's green-screen - would be nice if SDL had more blending modes...
+            for (int x = r.w; --x >= 0; src++)
+                *dst++ = *src == mask ? 0 : *src;
+        } else {
+            memcpy(dst, src, r.w * sizeof(Uint32));
+        }
+    }
+    unionRect(&uiDirty, &r);
     SDL_AtomicSet(&blitUI, 1);
     SDL_AtomicUnlock(&uiBufferLock);
     SDL_UnlockSurface(sdlscrn);
 }
 
+/* Dialog area updated since the last status bar update. Dialogs may restore
+ * the screen beneath them without an update, so it is copied again then. */
+static SDL_Rect uiDialog;
+
+static void uiFlushDialog(void) {
+    if (uiDialog.w && uiDialog.h) {
+        uiUpdateRect(&uiDialog);
+        uiDialog.w = uiDialog.h = 0;
+    }
+}
+
 bool Update_StatusBar(void) {
-    shieldStatusBarUpdate = true;
     Statusbar_OverlayBackup(sdlscrn);
     Statusbar_Update(sdlscrn);
-    shieldStatusBarUpdate = false;
-
-    statusBarUpdate();
+    uiFlushDialog();
     
     return !bQuitProgram;
 }
 
-/*
- Copy UI SDL surface to uiBuffer and replace mask pixels with transparent pixels for
- UI blending with framebuffer texture.
-*/
-static void uiUpdate(void) {
-    SDL_LockSurface(sdlscrn);
-    int     count = sdlscrn->w * sdlscrn->h;
-    Uint32* dst   = (Uint32*)uiBuffer;
-    Uint32* src   = (Uint32*)sdlscrn->pixels;
-    SDL_AtomicLock(&uiBufferLock);
-    // poor man's green-screen - would be nice if SDL had more blending modes...
-    for(int i = count; --i >= 0; src++)
-        *dst++ = *src == mask ? 0 : *src;
-    SDL_AtomicSet(&blitUI, 1);
-    SDL_AtomicUnlock(&uiBufferLock);
-    SDL_UnlockSurface(sdlscrn);
-}
-
 void SDL_UpdateRects(SDL_Surface *screen, int numrects, SDL_Rect *rects) {
-    while(numrects--) {
-        if(rects->y < NeXT_SCRN_HEIGHT) {
-            uiUpdate();
-            doUIblit = true;
-        } else {
-            if(doUIblit) {
-                uiUpdate();
-                doUIblit = false;
-            } else {
-                statusBarUpdate();
+    for (; numrects > 0; numrects--, rects++) {
+        if (rects->y < NeXT_SCRN_HEIGHT) {
+            SDL_Rect r = *rects;
+            if (!r.w || !r.h) {
+                r.x = r.y = 0;
+                r.w = screen->w;
+                r.h = screen->h;
             }
+            unionRect(&uiDialog, &r);
+        } else {
+            uiFlushDialog();
         }
+        uiUpdateRect(rects);
     }
 }
 
@@ -518,3 +595,96 @@ void SDL_UpdateRect(SDL_Surface *screen, Sint32 x, Sint32 y, Sint32 w, Sint32 h)
     SDL_Rect rect = { x, y, w, h };
     SDL_UpdateRects(screen, 1, &rect);
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save NeXT framebuffer (without UI overlay) to a PNG file.
+ * Return true on success.
+ */
+bool Screen_SaveSnapshot(const char* filename) {
+#if HAVE_LIBPNG
+    Uint32*     fb;
+    Uint8*      row;
+    FILE*       fp;
+    png_structp png_ptr;
+    png_infop   info_ptr;
+    Uint8       r, g, b;
+    bool        dimension = ConfigureParams.Screen.nMonitorType==MONITOR_TYPE_DIMENSION;
+    Uint32*     vram      = NULL;
+    
+    if (dimension) {
+        vram = nd_vram_for_slot(ND_SLOT(ConfigureParams.Screen.nMonitorNum));
+        if (!vram) return false;
+#if !ND_STEP
+        vram += 16;
+#endif
+    } else if (!NEXTVideo || !fbFormat) {
+        return false;
+    }
+    
+    fb  = malloc(NeXT_SCRN_WIDTH * NeXT_SCRN_HEIGHT * sizeof(Uint32));
+    row = malloc(NeXT_SCRN_WIDTH * 3);
+    if (!fb || !row) {
+        free(fb);
+        free(row);
+        return false;
+    }
+    if (!dimension) {
+        if (ConfigureParams.System.bColor) {
+            convertColor(fb);
+        } else {
+            convertBW(fb);
+        }
+    }
+    
+    fp = File_Open(filename, "wb");
+    if (!fp) {
+        free(fb);
+        free(row);
+        return false;
+    }
+    png_ptr  = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    info_ptr = png_ptr ? png_create_info_struct(png_ptr) : NULL;
+    if (!info_ptr || setjmp(png_jmpbuf(png_ptr))) {
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        File_Close(fp);
+        free(fb);
+        free(row);
+        return false;
+    }
+    png_init_io(png_ptr, fp);
+    png_set_IHDR(png_ptr, info_ptr, NeXT_SCRN_WIDTH, NeXT_SCRN_HEIGHT, 8,
+                 PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png_ptr, info_ptr);
+    
+    for (int y = 0; y < NeXT_SCRN_HEIGHT; y++) {
+        for (int x = 0; x < NeXT_SCRN_WIDTH; x++) {
+            if (dimension) {
+                Uint32 v = vram[y*(NeXT_SCRN_WIDTH+32)+x];
+                if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
+                    r = v >> 8; g = v >> 16; b = v >> 24;
+                } else {
+                    r = v >> 16; g = v >> 8; b = v;
+                }
+            } else {
+                SDL_GetRGB(fb[y*NeXT_SCRN_WIDTH+x], fbFormat, &r, &g, &b);
+            }
+            row[x*3+0] = r;
+            row[x*3+1] = g;
+            row[x*3+2] = b;
+        }
+        png_write_row(png_ptr, row);
+    }
+    png_write_end(png_ptr, NULL);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    File_Close(fp);
+    free(fb);
+    free(row);
+    return true;
+#else
+    Log_Printf(LOG_WARN, "Screen snapshot not possible: compiled without PNG support.\n");
+    return false;
+#endif
+}
@@ -28,6 +28,10 @@ const char File_fileid[] = "Hatari file.c : " __DATE__ " " __TIME__;
 #include "str.h"
 #include "zip.h"
 
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
 #if defined(WIN32)
 #define ftello ftell
 #endif
@@ -578,10 +582,31 @@ FILE *File_Close(FILE *fp)
 
 /*-----------------------------------------------------------------------*/
 /**
- * Read data from given FILE pointer to buffer and return status
+ * Read data from given FILE pointer to buffer and return status.
+ * Uses a single pread() where available, the stream position is not used.
  */
 bool File_Read(Uint8 *data, Uint32 size, Uint64 offset, FILE *fp)
 {
+#if HAVE_PREAD
+    int fh = fileno(fp);
+    ssize_t n;
+
+    while (size > 0)
+    {
+        n = pread(fh, data, size, offset);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+                continue;
+            fprintf(stderr, "Error occured while reading file.\n");
+            return false;
+        }
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+#else
     if (fseek(fp, offset, SEEK_SET))
     {
         fprintf(stderr, "File seek failed:\n  %s\n", strerror(errno));
@@ -593,15 +618,37 @@ bool File_Read(Uint8 *data, Uint32 size, Uint64 offset, FILE *fp)
         return false;
     }
     return true;
+#endif
 }
 
 
 /*-----------------------------------------------------------------------*/
 /**
- * Write data to given FILE pointer and return status
+ * Write data to given FILE pointer and return status.
+ * Uses a single pwrite() where available, the stream position is not used.
  */
 bool File_Write(Uint8 *data, Uint32 size, Uint64 offset, FILE *fp)
 {
+#if HAVE_PWRITE
+    int fh = fileno(fp);
+    ssize_t n;
+
+    while (size > 0)
+    {
+        n = pwrite(fh, data, size, offset);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+                continue;
+            fprintf(stderr, "Error occured while writing file.\n");
+            return false;
+        }
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+#else
     if (fseek(fp, offset, SEEK_SET))
     {
         fprintf(stderr, "File seek failed:\n  %s\n", strerror(errno));
@@ -613,6 +660,135 @@ bool File_Write(Uint8 *data, Uint32 size, Uint64 offset, FILE *fp)
         return false;
     }
     return true;
+#endif
+}
+
+
+/* Memory mapped disk images */
+#define FILE_MAX_MAPS 16
+
+static struct {
+    Uint8* addr;
+    Uint64 size;
+} file_maps[FILE_MAX_MAPS];
+
+static int File_FindMap(const Uint8 *map)
+{
+    int i;
+
+    for (i = 0; i < FILE_MAX_MAPS; i++)
+    {
+        if (map && file_maps[i].addr == map)
+            return i;
+    }
+    return -1;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Map the whole file into memory, shared with the file. Returns NULL if
+ * the file can not be mapped, it has to be accessed with File_Read() and
+ * File_Write() then.
+ */
+Uint8 *File_Map(FILE *fp, bool write)
+{
+#if HAVE_MMAP
+    struct stat st;
+    void *addr;
+    int i;
+
+    if (!fp || fstat(fileno(fp), &st) || st.st_size <= 0 || (Uint64)st.st_size > SIZE_MAX)
+        return NULL;
+    for (i = 0; i < FILE_MAX_MAPS && file_maps[i].addr; i++)
+        ;
+    if (i == FILE_MAX_MAPS)
+        return NULL;
+
+    addr = mmap(NULL, st.st_size, write ? PROT_READ|PROT_WRITE : PROT_READ, MAP_SHARED, fileno(fp), 0);
+    if (addr == MAP_FAILED)
+    {
+        fprintf(stderr, "File mapping failed:\n  %s\n", strerror(errno));
+        return NULL;
+    }
+    file_maps[i].addr = addr;
+    file_maps[i].size = st.st_size;
+    return addr;
+#else
+    return NULL;
+#endif
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Write back and unmap a file mapped with File_Map().
+ */
+void File_Unmap(Uint8 *map)
+{
+#if HAVE_MMAP
+    int i = File_FindMap(map);
+
+    if (i < 0)
+        return;
+    msync(file_maps[i].addr, file_maps[i].size, MS_SYNC);
+    munmap(file_maps[i].addr, file_maps[i].size);
+    file_maps[i].addr = NULL;
+    file_maps[i].size = 0;
+#endif
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Write back all mapped files. Without wait the write back is only
+ * scheduled.
+ */
+void File_SyncMaps(bool wait)
+{
+#if HAVE_MMAP
+    int i;
+
+    for (i = 0; i < FILE_MAX_MAPS; i++)
+    {
+        if (file_maps[i].addr)
+            msync(file_maps[i].addr, file_maps[i].size, wait ? MS_SYNC : MS_ASYNC);
+    }
+#endif
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Read data from the mapping if it covers the range, else from the file.
+ */
+bool File_MapRead(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp)
+{
+    int i = File_FindMap(map);
+
+    if (i >= 0 && offset + size <= file_maps[i].size)
+    {
+        memcpy(data, map + offset, size);
+        return true;
+    }
+    return File_Read(data, size, offset, fp);
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Write data to the mapping if it covers the range, else to the file.
+ */
+bool File_MapWrite(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp)
+{
+    int i = File_FindMap(map);
+
+    if (i >= 0 && offset + size <= file_maps[i].size)
+    {
+        memcpy(map + offset, data, size);
+        return true;
+    }
+    return File_Write(data, size, offset, fp);
 }
 
 
@@ -10,7 +10,9 @@
 #include "floppy.h"
 #include "cycInt.h"
 #include "file.h"
+#include "diskio.h"
 #include "statusbar.h"
+#include "memorySnapShot.h"
 
 
 #define LOG_FLP_REG_LEVEL   LOG_DEBUG
@@ -48,6 +50,7 @@ struct {
     Uint8 blocksize;
     
     FILE* dsk;
+    Uint8* map; /* memory mapped image, NULL if not mapped */
     Uint32 floppysize;
     
     Uint32 seekoffset;
@@ -976,7 +979,7 @@ static void floppy_read_sector(void) {
         Log_Printf(LOG_FLP_CMD_LEVEL, "[Floppy] Read sector at offset %i",logical_sec);
 
         flp_buffer.size = flp_buffer.limit = sec_size;
-        File_Read(flp_buffer.data, flp_buffer.size, logical_sec*sec_size, flpdrv[drive].dsk);
+        DiskIO_Read(flpdrv[drive].map, flp_buffer.data, flp_buffer.size, logical_sec*sec_size, flpdrv[drive].dsk);
         flpdrv[drive].sector++;
         flp_sector_counter--;
     }
@@ -1004,7 +1007,7 @@ static void floppy_write_sector(void) {
     } else {
         Log_Printf(LOG_FLP_CMD_LEVEL, "[Floppy] Write sector at offset %i",logical_sec);
         
-        File_Write(flp_buffer.data, flp_buffer.size, logical_sec*sec_size, flpdrv[drive].dsk);
+        DiskIO_Write(flpdrv[drive].map, flp_buffer.data, flp_buffer.size, logical_sec*sec_size, flpdrv[drive].dsk);
         flp_buffer.size = 0;
         flp_buffer.limit = sec_size;
         flpdrv[drive].sector++;
@@ -1047,7 +1050,7 @@ static void floppy_format_sector(void) {
     } else {
         Log_Printf(LOG_FLP_CMD_LEVEL, "[Floppy] Format sector at offset %i (%i/%i/%i), blocksize: %i",
                    logical_sec,c,h,s,sec_size);
-        File_Write(flp_buffer.data, flp_buffer.size, logical_sec*sec_size, flpdrv[drive].dsk);
+        DiskIO_Write(flpdrv[drive].map, flp_buffer.data, flp_buffer.size, logical_sec*sec_size, flpdrv[drive].dsk);
         flp_buffer.size = 0;
         flp_buffer.limit = 4;
     }
@@ -1159,9 +1162,19 @@ static void Floppy_Init(void) {
 }
 
 static void Floppy_Uninit(void) {
-    if (flpdrv[0].dsk)
+    File_Unmap(flpdrv[0].map);
+    File_Unmap(flpdrv[1].map);
+    flpdrv[0].map = flpdrv[1].map = NULL;
+    if (flpdrv[0].dsk) {
+        if (!DiskIO_Flush(flpdrv[0].dsk, true)) {
+            Log_Printf(LOG_WARN, "Floppy disk 0: Writing image file failed");
+        }
         File_Close(flpdrv[0].dsk);
+    }
     if (flpdrv[1].dsk) {
+        if (!DiskIO_Flush(flpdrv[1].dsk, true)) {
+            Log_Printf(LOG_WARN, "Floppy disk 1: Writing image file failed");
+        }
         File_Close(flpdrv[1].dsk);
     }
     flpdrv[0].dsk = flpdrv[1].dsk = NULL;
@@ -1230,6 +1243,10 @@ int Floppy_Insert(int drive) {
         }
     }
     
+    if (ConfigureParams.System.bMapDiskImages) {
+        flpdrv[drive].map = File_Map(flpdrv[drive].dsk, !flpdrv[drive].protected);
+    }
+    
     flpdrv[drive].inserted=true;
     flpdrv[drive].spinning=false;
 
@@ -1251,6 +1268,11 @@ void Floppy_Eject(int drive) {
     Log_Printf(LOG_WARN, "Unloading floppy disk %i",drive);
     Log_Printf(LOG_WARN, "Floppy disk %i: Eject",drive);
     
+    File_Unmap(flpdrv[drive].map);
+    flpdrv[drive].map=NULL;
+    if (flpdrv[drive].dsk && !DiskIO_Flush(flpdrv[drive].dsk, true)) {
+        Log_Printf(LOG_WARN, "Floppy disk %i: Writing image file failed",drive);
+    }
     File_Close(flpdrv[drive].dsk);
     flpdrv[drive].floppysize = 0;
     flpdrv[drive].blocksize = 0;
@@ -1266,3 +1288,43 @@ void Floppy_Reset(void) {
     Floppy_Uninit();
     Floppy_Init();
 }
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of floppy variables ('MemorySnapShot_Store' handles type)
+ */
+void Floppy_MemorySnapShot_Capture(bool bSave) {
+    int i;
+    
+    MemorySnapShot_Store(&flp, sizeof(flp));
+    MemorySnapShot_Store(&floppy_select, sizeof(floppy_select));
+    MemorySnapShot_Store(&flp_io_state, sizeof(flp_io_state));
+    MemorySnapShot_Store(&flp_sector_counter, sizeof(flp_sector_counter));
+    MemorySnapShot_Store(&flp_io_drv, sizeof(flp_io_drv));
+    MemorySnapShot_Store(&cmd_phase, sizeof(cmd_phase));
+    MemorySnapShot_Store(&cmd_size, sizeof(cmd_size));
+    MemorySnapShot_Store(&cmd_limit, sizeof(cmd_limit));
+    MemorySnapShot_Store(&command, sizeof(command));
+    MemorySnapShot_Store(cmd_data, sizeof(cmd_data));
+    MemorySnapShot_Store(&result_size, sizeof(result_size));
+    MemorySnapShot_Store(&flp_buffer, sizeof(flp_buffer));
+    
+    /* Media state comes from the configuration, keep it from Floppy_Reset() */
+    for (i = 0; i < FLP_MAX_DRIVES; i++) {
+        FILE*  dsk        = flpdrv[i].dsk;
+        Uint8* map        = flpdrv[i].map;
+        Uint32 floppysize = flpdrv[i].floppysize;
+        bool   protect    = flpdrv[i].protected;
+        bool   inserted   = flpdrv[i].inserted;
+        bool   connected  = flpdrv[i].connected;
+        
+        MemorySnapShot_Store(&flpdrv[i], sizeof(flpdrv[i]));
+        
+        flpdrv[i].dsk        = dsk;
+        flpdrv[i].map        = map;
+        flpdrv[i].floppysize = floppysize;
+        flpdrv[i].protected  = protect;
+        flpdrv[i].inserted   = inserted;
+        flpdrv[i].connected  = connected;
+    }
+}
@@ -180,6 +180,12 @@ int DlgAlert_Notice(const char *text)
 	return HookedAlertNotice(text);
 #endif
 
+	/* No dialogs in headless mode */
+	if (bHeadless) {
+		fprintf(stderr, "%s\n", text);
+		return true;
+	}
+
 	/* Hide "cancel" button: */
 	alertdlg[DLGALERT_CANCEL].type = SGTEXT;
 	alertdlg[DLGALERT_CANCEL].txt = "";
@@ -203,6 +209,12 @@ int DlgAlert_Query(const char *text)
 	return HookedAlertQuery(text);
 #endif
 
+	/* No dialogs in headless mode, always confirm */
+	if (bHeadless) {
+		fprintf(stderr, "%s\n", text);
+		return true;
+	}
+
 	/* Show "cancel" button: */
 	alertdlg[DLGALERT_CANCEL].type = SGBUTTON;
 	alertdlg[DLGALERT_CANCEL].txt = "Cancel";
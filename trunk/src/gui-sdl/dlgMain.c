@@ -36,6 +36,7 @@ const char DlgMain_fileid[] = "Hatari dlgMain.c : " __DATE__ " " __TIME__;
 #define MAINDLG_OK       19
 #define MAINDLG_QUIT     20
 #define MAINDLG_CANCEL   21
+#define MAINDLG_MEMORY   22
 
 
 /* The main dialog: */
@@ -56,13 +57,14 @@ static SGOBJ maindlg[] =
 	{ SGBUTTON, 0, 0, 35,6, 13,1, "Mouse" },
 	{ SGBUTTON, 0, 0, 35,8, 13,1, "Sound" },
 	{ SGBUTTON, 0, 0, 35,10, 13,1, "Printer" },
-	{ SGBUTTON, 0, 0, 7,13, 16,1, "Load config." },
-	{ SGBUTTON, 0, 0, 27,13, 16,1, "Save config." },
+	{ SGBUTTON, 0, 0, 2,13, 14,1, "Load config." },
+	{ SGBUTTON, 0, 0, 18,13, 14,1, "Save config." },
 	{ SGCHECKBOX, 0, 0, 3,15, 15,1, "Reset machine" },
     { SGCHECKBOX, 0, 0, 3,17, 15,1, "Show at startup" },
 	{ SGBUTTON, SG_DEFAULT, 0, 21,15, 8,3, "OK" },
 	{ SGBUTTON, 0, 0, 36,15, 10,1, "Quit" },
 	{ SGBUTTON, SG_CANCEL, 0, 36,17, 10,1, "Cancel" },
+	{ SGBUTTON, 0, 0, 34,13, 14,1, "Memory state" },
 	{ -1, 0, 0, 0,0, 0,0, NULL }
 };
 
@@ -142,6 +144,16 @@ int Dialog_MainDlg(bool *bReset, bool *bLoadedSnapshot)
 		 case MAINDLG_SOUND:
 			DlgSound_Main();
 			break;
+		 case MAINDLG_MEMORY:
+			if (Dialog_MemDlg())
+			{
+				/* Memory snapshot has been loaded - leave GUI immediately */
+				*bLoadedSnapshot = true;
+				SDL_ShowCursor(bOldMouseVisibility);
+				Main_WarpMouse(nOldMouseX, nOldMouseY);
+				return true;
+			}
+			break;
 		 case MAINDLG_LOADCFG:
 			psNewCfg = SDLGui_FileSelect(sConfigFileName, NULL, false);
 			if (psNewCfg)
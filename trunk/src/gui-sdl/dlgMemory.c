@@ -11,8 +11,9 @@ const char DlgMemory_fileid[] = "Previous dlgMemory.c : " __DATE__ " " __TIME__;
 #include "sdlgui.h"
 #include "file.h"
 #include "screen.h"
+#include "memorySnapShot.h"
 
-#define GUI_SAVE_MEMORY 0
+#define GUI_SAVE_MEMORY 1
 
 #define DLGMEM_8MB      4
 #define DLGMEM_16MB     5
@@ -40,6 +41,10 @@ const char DlgMemory_fileid[] = "Previous dlgMemory.c : " __DATE__ " " __TIME__;
 void Dialog_MemDlgDraw(void);
 char custom_memsize[16] = "Customize";
 
+#if GUI_SAVE_MEMORY
+static char dlgSnapShotName[36+1];
+#endif
+
 /* The memory dialog: */
 static SGOBJ memorydlg[] =
 {
@@ -66,10 +71,9 @@ static SGOBJ memorydlg[] =
 	{ SGRADIOBUT, 0, 0, 23,8, 7,1, "80 ns" },
 	{ SGRADIOBUT, 0, 0, 23,9, 7,1, "60 ns" },
     
-    { SGBUTTON, SG_DEFAULT, 0, 10,15, 23,1, "Back to system menu" },
 #if GUI_SAVE_MEMORY
 	{ SGBOX, 0, 0, 1,14, 39,10, NULL },
-	{ SGTEXT, 0, 0, 2,15, 17,1, "Load/Save memory state (untested)" },
+	{ SGTEXT, 0, 0, 2,15, 17,1, "Load/Save memory state" },
 	{ SGTEXT, 0, 0, 2,17, 20,1, "Snap-shot file name:" },
 	{ SGTEXT, 0, 0, 2,18, 36,1, dlgSnapShotName },
 	{ SGBUTTON, 0, 0, 8,20, 10,1, "Save" },
@@ -77,6 +81,8 @@ static SGOBJ memorydlg[] =
 	{ SGCHECKBOX, 0, 0, 2,22, 37,1, "Load/save state at start-up/exit" },
     
     { SGBUTTON, SG_DEFAULT, 0, 10,26, 21,1, "Back to main menu" },
+#else
+    { SGBUTTON, SG_DEFAULT, 0, 10,15, 23,1, "Back to system menu" },
 #endif
 	{ -1, 0, 0, 0,0, 0,0, NULL }
 };
@@ -89,6 +89,14 @@ void DlgMissing_Rom(const char* type, char *imgname, const char *defname, bool *
     char missingrom_alert[64];
     
     bool bOldMouseVisibility;
+    
+    /* No dialogs in headless mode */
+    if (bHeadless) {
+        fprintf(stderr, "%s: ROM file not found: %s\n", type, imgname);
+        bQuitProgram = true;
+        return;
+    }
+    
     bOldMouseVisibility = SDL_ShowCursor(SDL_QUERY);
     SDL_ShowCursor(SDL_ENABLE);
     
@@ -160,6 +168,14 @@ void DlgMissing_Disk(const char* type, int num, char *imgname, bool *inserted, b
     char missingdisk_disk[64];
     
     bool bOldMouseVisibility;
+    
+    /* No dialogs in headless mode */
+    if (bHeadless) {
+        fprintf(stderr, "%s drive %i: disk image not found: %s\n", type, num, imgname);
+        bQuitProgram = true;
+        return;
+    }
+    
     bOldMouseVisibility = SDL_ShowCursor(SDL_QUERY);
     SDL_ShowCursor(SDL_ENABLE);
 
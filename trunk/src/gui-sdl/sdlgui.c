@@ -946,6 +946,7 @@ int SDLGui_DoDialog(SGOBJ *dlg, SDL_Event *pEventOut)
 	{
 		SDL_BlitSurface(pBgSurface, &bgrect, pSdlGuiScrn,  &dlgrect);
 		SDL_FreeSurface(pBgSurface);
+		SDL_UpdateRects(pSdlGuiScrn, 1, &dlgrect);
 	}
 
 	/* Copy event data of unsupported events if caller wants to have it */
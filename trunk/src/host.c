@@ -15,6 +15,10 @@
 #include "log.h"
 #include "memory.h"
 #include "newcpu.h"
+#include "memorySnapShot.h"
+
+extern Sint64           nCyclesMainCounter;
+extern struct regstruct regs;
 
 /* NeXTdimension blank handling, see nd_sdl.c */
 void nd_display_blank(int num);
@@ -27,37 +31,82 @@ static const char* BLANKS[] = {
 
 static volatile Uint32 blank[NUM_BLANKS];
 static Uint32       vblCounter[NUM_BLANKS];
-static Uint64       perfCounterStart;
-static Sint64       cycleCounterStart;
-static double       cycleSecsStart;
-static bool         currentIsRealtime;
-static double       cycleDivisor;
-static lock_t       timeLock;
 static Uint32       ticksStart;
-static bool         enableRealtime;
 static Uint64       hardClockExpected;
 static Uint64       hardClockActual;
 static time_t       unixTimeStart;
 static double       unixTimeOffset = 0;
-static double       perfFrequency;
+static Uint64       perfFrequency;
 static Uint64       pauseTimeStamp;
 static bool         osDarkmatter;
 
+/* Clock state. It is only modified by the thread that called host_reset()
+ * (the m68k thread) and published to other threads with a sequence lock.
+ * All times are in nanoseconds. */
+typedef struct {
+    bool   isRealtime;
+    Uint64 perfCounterStart;
+    Sint64 cycleCounterStart;
+    Sint64 cycleNsStart;
+    int    cpuFreqMHz;
+} clock_state_t;
+
+static clock_state_t clk;          /* private copy of the owner thread */
+static clock_state_t clkShared;    /* copy published for other threads */
+static atomic_int    clkSeq;
+static SDL_threadID  clkOwner;
+static bool          enableRealtime;
+
+static void clock_publish(void) {
+    SDL_AtomicAdd(&clkSeq, 1);
+    SDL_MemoryBarrierRelease();
+    clkShared = clk;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicAdd(&clkSeq, 1);
+}
+
+static void clock_read(clock_state_t* state) {
+    int seq;
+    do {
+        seq = SDL_AtomicGet(&clkSeq);
+        SDL_MemoryBarrierAcquire();
+        *state = clkShared;
+        SDL_MemoryBarrierAcquire();
+    } while ((seq & 1) || seq != SDL_AtomicGet(&clkSeq));
+}
+
+static inline Sint64 real_time_ns_from(const clock_state_t* state) {
+    Uint64 delta = SDL_GetPerformanceCounter() - state->perfCounterStart;
+    return (delta / perfFrequency) * 1000000000LL + ((delta % perfFrequency) * 1000000000LL) / perfFrequency;
+}
+
+static inline Sint64 cycle_time_ns_from(const clock_state_t* state) {
+    return ((nCyclesMainCounter - state->cycleCounterStart) * 1000LL) / state->cpuFreqMHz + state->cycleNsStart;
+}
+
+static inline Sint64 real_time_ns(void) {
+    clock_state_t state;
+    if(SDL_ThreadID() == clkOwner)
+        return real_time_ns_from(&clk);
+    clock_read(&state);
+    return real_time_ns_from(&state);
+}
+
 static inline double real_time() {
-    double rt  = (SDL_GetPerformanceCounter() - perfCounterStart);
-    rt        /= perfFrequency;
-    return rt;
+    return real_time_ns() / 1000000000.0;
 }
 
 void host_reset() {
-    perfCounterStart  = SDL_GetPerformanceCounter();
-    pauseTimeStamp    = perfCounterStart;
+    clkOwner              = SDL_ThreadID();
+    clk.perfCounterStart  = SDL_GetPerformanceCounter();
+    clk.cycleCounterStart = 0;
+    clk.cycleNsStart      = 0;
+    clk.isRealtime        = false;
+    clk.cpuFreqMHz        = ConfigureParams.System.nCpuFreq;
+    pauseTimeStamp    = clk.perfCounterStart;
     perfFrequency     = SDL_GetPerformanceFrequency();
     ticksStart        = SDL_GetTicks();
     unixTimeStart     = time(NULL);
-    cycleCounterStart = 0;
-    cycleSecsStart    = 0;
-    currentIsRealtime = false;
     hardClockExpected = 0;
     hardClockActual   = 0;
     enableRealtime    = ConfigureParams.System.bRealtime;
@@ -68,7 +117,7 @@ void host_reset() {
         blank[i]      = 0;
     }
     
-    cycleDivisor = ConfigureParams.System.nCpuFreq * 1000 * 1000;
+    clock_publish();
     
     SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
 }
@@ -97,6 +146,11 @@ bool host_blank_state(int slot, int src) {
     return blank[src] & bit;
 }
 
+/* Owner thread: true if host time currently follows the real-time clock */
+bool host_is_realtime(void) {
+    return clk.isRealtime;
+}
+
 void host_hardclock(int expected, int actual) {
     if(abs(actual-expected) > 1000) {
         Log_Printf(LOG_WARN, "[Hardclock] expected:%dus actual:%dus\n", expected, actual);
@@ -106,52 +160,58 @@ void host_hardclock(int expected, int actual) {
     }
 }
 
-extern Sint64           nCyclesMainCounter;
-extern struct regstruct regs;
-
-double host_time_sec() {
-    double hostTime;
-    
-    host_lock(&timeLock);
+/* Owner thread: compute time and switch between real-time and cycle-time */
+static Sint64 host_time_ns_owner(void) {
+    Sint64 hostTime = clk.isRealtime ? real_time_ns_from(&clk) : cycle_time_ns_from(&clk);
     
-    if(currentIsRealtime) {
-        hostTime = real_time();
-    } else {
-        hostTime  = nCyclesMainCounter - cycleCounterStart;
-        hostTime /= cycleDivisor;
-        hostTime += cycleSecsStart;
-    }
+    if(!enableRealtime)
+        return hostTime;
     
     // switch to realtime if...
     // 1) ...realtime mode is enabled and...
     // 2) ...either we are running darkmatter or the m68k CPU is in user mode
-    bool state = (osDarkmatter || !(regs.s)) && enableRealtime;
-    if(currentIsRealtime != state) {
-        double realTime  = real_time();
+    bool state = osDarkmatter || !(regs.s);
+    if(clk.isRealtime != state) {
+        Sint64 realTime = real_time_ns_from(&clk);
         
-        if(currentIsRealtime) {
+        if(clk.isRealtime) {
             // switching from real-time to cycle-time
-            cycleSecsStart    = realTime;
-            cycleCounterStart = nCyclesMainCounter;
+            clk.cycleNsStart      = realTime;
+            clk.cycleCounterStart = nCyclesMainCounter;
         } else {
             // switching from cycle-time to real-time
-            double realTimeOffset = hostTime - realTime;
+            Sint64 realTimeOffset = hostTime - realTime;
             if(realTimeOffset > 0) {
                 // if hostTime is in the future, wait until realTime is there as well
-                if(realTimeOffset > 0.01)
-                    host_sleep_sec(realTimeOffset);
+                if(realTimeOffset > 10000000LL)
+                    host_sleep_us(realTimeOffset / 1000);
                 else
-                    while(real_time() < hostTime) {}
+                    while(real_time_ns_from(&clk) < hostTime) {}
             }
         }
-        currentIsRealtime = state;
+        clk.isRealtime = state;
+        clock_publish();
     }
     
-    host_unlock(&timeLock);
-    
     return hostTime;
 }
 
+// Return current time as nano seconds
+static Sint64 host_time_ns(void) {
+    clock_state_t state;
+    
+    if(SDL_ThreadID() == clkOwner)
+        return host_time_ns_owner();
+    
+    // other threads only read the published clock state
+    clock_read(&state);
+    return state.isRealtime ? real_time_ns_from(&state) : cycle_time_ns_from(&state);
+}
+
+double host_time_sec() {
+    return host_time_ns() / 1000000000.0;
+}
+
 void host_time(double* realTime, double* hostTime) {
     *hostTime = host_time_sec();
     *realTime = real_time();
@@ -159,12 +219,12 @@ void host_time(double* realTime, double* hostTime) {
 
 // Return current time as micro seconds
 Uint64 host_time_us() {
-    return host_time_sec() * 1000.0 * 1000.0;
+    return host_time_ns() / 1000LL;
 }
 
 // Return current time as milliseconds
 Uint32 host_time_ms() {
-    return  host_time_us() / 1000LL;
+    return host_time_ns() / 1000000LL;
 }
 
 time_t host_unix_time() {
@@ -186,7 +246,34 @@ void host_pause_time(bool pausing) {
     if(pausing) {
         pauseTimeStamp = SDL_GetPerformanceCounter();
     } else {
-        perfCounterStart += SDL_GetPerformanceCounter() - pauseTimeStamp;
+        clk.perfCounterStart += SDL_GetPerformanceCounter() - pauseTimeStamp;
+        clock_publish();
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore emulated time. Must be restored after nCyclesMainCounter.
+ * The clock restarts in cycle-time at the saved host time and the guest's
+ * wall clock continues where it was when the snapshot was taken.
+ */
+void host_MemorySnapShot_Capture(bool bSave) {
+    Sint64 hostTime = bSave ? host_time_ns() : 0;
+    
+    MemorySnapShot_Store(&hostTime, sizeof(hostTime));
+    MemorySnapShot_Store(&unixTimeStart, sizeof(unixTimeStart));
+    MemorySnapShot_Store(&unixTimeOffset, sizeof(unixTimeOffset));
+    MemorySnapShot_Store(&osDarkmatter, sizeof(osDarkmatter));
+    
+    if (!bSave) {
+        Uint64 perfTime = (hostTime / 1000000000LL) * perfFrequency + ((hostTime % 1000000000LL) * perfFrequency) / 1000000000LL;
+        
+        clk.isRealtime        = false;
+        clk.cycleCounterStart = nCyclesMainCounter;
+        clk.cycleNsStart      = hostTime;
+        clk.perfCounterStart  = SDL_GetPerformanceCounter() - perfTime;
+        pauseTimeStamp        = SDL_GetPerformanceCounter();
+        clock_publish();
     }
 }
 
@@ -247,6 +334,43 @@ bool host_atomic_cas(atomic_int* a, int oldValue, int newValue) {
     return SDL_AtomicCAS(a, oldValue, newValue);
 }
 
+int host_atomic_add(atomic_int* a, int value) {
+    return SDL_AtomicAdd(a, value);
+}
+
+int host_atomic_or(atomic_int* a, int value) {
+    int old;
+    do {
+        old = SDL_AtomicGet(a);
+    } while (!SDL_AtomicCAS(a, old, old | value));
+    return old;
+}
+
+int host_atomic_and(atomic_int* a, int value) {
+    int old;
+    do {
+        old = SDL_AtomicGet(a);
+    } while (!SDL_AtomicCAS(a, old, old & value));
+    return old;
+}
+
+semaphore_t* host_sem_create(void) {
+    return SDL_CreateSemaphore(0);
+}
+
+void host_sem_destroy(semaphore_t* sem) {
+    SDL_DestroySemaphore(sem);
+}
+
+void host_sem_post(semaphore_t* sem) {
+    SDL_SemPost(sem);
+}
+
+/* Returns true if the semaphore was posted, false on timeout */
+bool host_sem_wait(semaphore_t* sem, Uint32 ms) {
+    return SDL_SemWaitTimeout(sem, ms) == 0;
+}
+
 thread_t* host_thread_create(thread_func_t func, const char* name, void* data) {
   return SDL_CreateThread(func, name, data);
 }
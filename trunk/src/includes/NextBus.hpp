@@ -30,6 +30,7 @@ extern "C" {
     
     void NextBus_Reset(void);
     void NextBus_Pause(bool pause);
+    void NextBus_MemorySnapShot_Capture(bool bSave);
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -63,6 +64,7 @@ public:
     
     virtual void   reset(void);
     virtual void   pause(bool pause);
+    virtual void   snapshot(bool bSave);
 };
 
 class NextBusBoard : public NextBusSlot {
@@ -132,6 +132,8 @@ typedef struct
 {
   int nMemoryBankSize[4];
   MEMORY_SPEED nMemorySpeed;
+  bool bAutoSave;
+  char szMemoryCaptureFileName[FILENAME_MAX];
 } CNF_MEMORY;
 
 
@@ -171,6 +173,7 @@ typedef enum {
 
 typedef struct {
     char szImageName[FILENAME_MAX];
+    char szOverlayName[FILENAME_MAX]; /* used if write protection is on */
     SCSI_DEVTYPE nDeviceType;
     bool bDiskInserted;
     bool bWriteProtected;
@@ -312,12 +315,18 @@ typedef struct
   bool bCompatibleCpu;            /* Prefetch mode */
   MACHINETYPE nMachineType;
   bool bRealtime;                 /* TRUE if realtime sources shoud be used */
+  bool bIdleSkip;                 /* TRUE if idle time is skipped to the next event */
+  char szIdleLoopPCs[FILENAME_MAX]; /* comma separated list of idle loop addresses */
   DSPTYPE nDSPType;               /* how to "emulate" DSP */
   bool bDSPMemoryExpansion;
+  bool bDSPThread;                /* TRUE if DSP runs on its own host thread */
+  int nDSPMaxSkew;                /* DSP cycles the DSP thread may lag behind */
   bool bRealTimeClock;
   FPUTYPE n_FPUType;
   bool bCompatibleFPU;            /* More compatible FPU */
   bool bMMU;                      /* TRUE if MMU is enabled */
+  bool bMapDiskImages;            /* TRUE if disk images are memory mapped */
+  bool bAsyncDiskIO;              /* TRUE if disk images are written by an I/O thread */
 } CNF_SYSTEM;
 
 /* NeXT Dimension configuration */
@@ -331,6 +340,8 @@ typedef struct
 
 typedef struct {
     bool bI860Thread;
+    bool bI860HostFPU;
+    bool bI860HostFPUCheck;
     bool bMainDisplay;
     int nMainDisplay;
     NDBOARD board[ND_MAX_BOARDS];
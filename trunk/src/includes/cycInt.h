@@ -50,17 +50,21 @@ enum {
 typedef struct
 {
     int     type;   /* Type of time (CPU Cycles, microseconds) or NONE for inactive */
-    int64_t time;   /* number of CPU cycles to go until interupt or absolute microsecond timeout until interrupt */
+    int64_t time;   /* absolute CPU cycle (nCyclesMainCounter) or absolute microsecond timeout until interrupt */
     void (*pFunction)(void);
 } INTERRUPTHANDLER;
 
 extern INTERRUPTHANDLER PendingInterrupt;
 
 extern int64_t nCyclesMainCounter;
-extern int64_t nCyclesOver;
 
 extern int usCheckCycles;
 
+/* True if the pending CPU cycle or microsecond interrupt is due */
+static inline bool CycInt_InterruptDue(void) {
+    return PendingInterrupt.time <= nCyclesMainCounter && PendingInterrupt.pFunction;
+}
+
 void CycInt_Reset(void);
 void CycInt_MemorySnapShot_Capture(bool bSave);
 void CycInt_AcknowledgeInterrupt(void);
@@ -70,6 +74,7 @@ void CycInt_AddRelativeInterruptUsCycles(int64_t us, int64_t usreal, interrupt_i
 void CycInt_RemovePendingInterrupt(interrupt_id Handler);
 bool CycInt_InterruptActive(interrupt_id Handler);
 bool CycInt_SetNewInterruptUs(void);
+void CycInt_SkipIdleTime(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,28 @@
+/*
+  Previous - diskio.h
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+*/
+
+#ifndef PREV_DISKIO_H
+#define PREV_DISKIO_H
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+bool DiskIO_Read(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp);
+bool DiskIO_Write(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp);
+bool DiskIO_Flush(FILE *fp, bool sync);
+void DiskIO_UnInit(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PREV_DISKIO_H */
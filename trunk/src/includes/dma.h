@@ -38,6 +38,8 @@ void DMA_Stop_Write(void);
 void DMA_Init_Read(void);
 void DMA_Init_Write(void);
 
+void DMA_MemorySnapShot_Capture(bool bSave);
+
 /* Turbo DMA functions */
 void TDMA_CSR_Read(void);
 void TDMA_CSR_Write(void);
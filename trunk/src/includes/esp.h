@@ -33,6 +33,8 @@ void ESP_DMA_FIFO_STAT_Write(void);
 
 void ESP_DMA_set_status(void);
 
+void ESP_MemorySnapShot_Capture(bool bSave);
+
 
 
 void ESP_TransCountL_Read(void); 
@@ -41,6 +41,7 @@ struct {
 
 void ENET_IO_Handler(void);
 void Ethernet_Reset(bool hard);
+void Ethernet_MemorySnapShot_Capture(bool bSave);
 void enet_receive(Uint8 *pkt, int len);
 
 /* Turbo ethernet controller */
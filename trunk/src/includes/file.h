@@ -33,6 +33,11 @@ FILE *File_Open(const char *path, const char *mode);
 FILE *File_Close(FILE *fp);
 bool File_Read(Uint8 *data, Uint32 size, Uint64 offset, FILE *fp);
 bool File_Write(Uint8 *data, Uint32 size, Uint64 offset, FILE *fp);
+Uint8 *File_Map(FILE *fp, bool write);
+void File_Unmap(Uint8 *map);
+void File_SyncMaps(bool wait);
+bool File_MapRead(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp);
+bool File_MapWrite(Uint8 *map, Uint8 *data, Uint32 size, Uint64 offset, FILE *fp);
 bool File_InputAvailable(FILE *fp);
 void File_MakeAbsoluteSpecialName(char *pszFileName);
 void File_MakeAbsoluteName(char *pszFileName);
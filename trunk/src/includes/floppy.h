@@ -14,6 +14,7 @@ void FLP_Select_Write(void);
 void FLP_IO_Handler(void);
 
 void Floppy_Reset(void);
+void Floppy_MemorySnapShot_Capture(bool bSave);
 int Floppy_Insert(int drive);
 void Floppy_Eject(int drive);
 
@@ -34,12 +34,14 @@ extern "C" {
     typedef SDL_atomic_t       atomic_int;
     typedef SDL_SpinLock       lock_t;
     typedef SDL_Thread         thread_t;
+    typedef SDL_sem            semaphore_t;
     typedef SDL_ThreadFunction thread_func_t;
 
     void        host_reset(void);
     void        host_blank(int slot, int src, bool state);
     bool        host_blank_state(int slot, int src);
     Uint64      host_time_us(void);
+    bool        host_is_realtime(void);
     Uint32      host_time_ms(void);
     double      host_time_sec(void);
     void        host_time(double* realTime, double* hostTime);
@@ -53,6 +55,7 @@ extern "C" {
     double      host_real_time_offset(void);
     void        host_pause_time(bool pausing);
     const char* host_report(double realTime, double hostTime);
+    void        host_MemorySnapShot_Capture(bool bSave);
     
     void        host_lock(lock_t* lock);
     void        host_unlock(lock_t* lock);
@@ -60,6 +63,13 @@ extern "C" {
     int         host_atomic_set(atomic_int* a, int newValue);
     int         host_atomic_get(atomic_int* a);
     bool        host_atomic_cas(atomic_int* a, int oldValue, int newValue);
+    int         host_atomic_add(atomic_int* a, int value);
+    int         host_atomic_or(atomic_int* a, int value);
+    int         host_atomic_and(atomic_int* a, int value);
+    semaphore_t* host_sem_create(void);
+    void        host_sem_destroy(semaphore_t* sem);
+    void        host_sem_post(semaphore_t* sem);
+    bool        host_sem_wait(semaphore_t* sem, Uint32 ms);
     thread_t*   host_thread_create(thread_func_t, const char* name, void* data);
     int         host_thread_wait(thread_t* thread);
     Uint8*      host_malloc_aligned(size_t size);
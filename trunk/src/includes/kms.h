@@ -1,4 +1,5 @@
 void KMS_Reset(void);
+void KMS_MemorySnapShot_Capture(bool bSave);
 
 void KMS_Ctrl_Snd_Write(void);
 void KMS_Stat_Snd_Read(void);
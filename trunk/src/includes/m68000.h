@@ -146,17 +146,31 @@ extern int	Pairing;
 extern char	PairingArray[ MAX_OPCODE_FAMILY ][ MAX_OPCODE_FAMILY ];
 extern const char *OpcodeName[];
 
+#define M68000_MAX_IDLE_LOOPS 4
+
+extern int nIdleLoopPCs;
+extern Uint32 IdleLoopPC[M68000_MAX_IDLE_LOOPS];
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Check if the CPU is about to execute a configured idle loop.
+ */
+static inline bool M68000_IsIdleLoop(Uint32 pc) {
+    int i;
+    for (i = 0; i < nIdleLoopPCs; i++) {
+        if (IdleLoopPC[i] == pc)
+            return true;
+    }
+    return false;
+}
+
 
 /*-----------------------------------------------------------------------*/
 /**
  * Add CPU cycles.
  */
 static inline void M68000_AddCycles(int cycles) {
-    nCyclesOver += cycles;
-    
-    if(PendingInterrupt.type == CYC_INT_CPU)
-        PendingInterrupt.time -= cycles;
-
     if(usCheckCycles < 0) {
         if(!(CycInt_SetNewInterruptUs())) {
             usCheckCycles = 100 * ConfigureParams.System.nCpuFreq;
@@ -168,6 +182,7 @@ static inline void M68000_AddCycles(int cycles) {
 
 void M68000_Init(void);
 void M68000_Reset(bool bCold);
+void M68000_MemorySnapShot_Capture(bool bSave);
 void M68000_Stop(void);
 void M68000_Start(void);
 void M68000_CheckCpuSettings(void);
@@ -67,6 +67,7 @@ enum {
 extern volatile int mainPauseEmulation;
 
 extern bool bQuitProgram;
+extern bool bHeadless;
 
 bool Main_PauseEmulation(bool visualize);
 bool Main_UnPauseEmulation(void);
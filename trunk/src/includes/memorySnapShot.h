@@ -0,0 +1,26 @@
+/*
+  Previous - memorySnapShot.h
+
+  This file is distributed under the GNU Public License, version 2 or at
+  your option any later version. Read the file gpl.txt for details.
+*/
+
+#pragma once
+
+#ifndef PREV_MEMORYSNAPSHOT_H
+#define PREV_MEMORYSNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+bool MemorySnapShot_Capture(const char *pszFileName, bool bConfirm);
+bool MemorySnapShot_Restore(const char *pszFileName, bool bConfirm);
+void MemorySnapShot_Store(void *pData, int Size);
+void MemorySnapShot_StorePages(void *pData, Uint32 Size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PREV_MEMORYSNAPSHOT_H */
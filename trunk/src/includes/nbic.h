@@ -16,6 +16,8 @@ void nb_cpu_slot_lput(Uint32 addr, Uint32 l);
 void nb_cpu_slot_wput(Uint32 addr, Uint16 w);
 void nb_cpu_slot_bput(Uint32 addr, Uint8 b);
 
+void NBIC_MemorySnapShot_Capture(bool bSave);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
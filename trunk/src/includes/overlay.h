@@ -0,0 +1,44 @@
+/*
+  Previous - overlay.h
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+*/
+
+#ifndef PREV_OVERLAY_H
+#define PREV_OVERLAY_H
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define OVERLAY_BLOCKSIZE   512
+
+/* Copy-on-write overlay of a disk image, see overlay.c for the file format */
+typedef struct overlay_s {
+    FILE*   fp;
+    char*   path;       /* NULL for temporary overlays */
+    Uint32  blocks;     /* size of the disk in blocks */
+    Uint32* index;      /* data slot + 1 for each block, 0 if not present */
+    Uint32  used;       /* allocated data slots */
+    Uint64  data;       /* file offset of the first data slot */
+    struct overlay_s* parent; /* NULL if the parent is the disk image */
+} OVERLAY;
+
+OVERLAY* Overlay_Open(const char *path, Uint32 blocks);
+OVERLAY* Overlay_Push(OVERLAY *ov, const char *path);
+void     Overlay_Close(OVERLAY *ov);
+bool     Overlay_Read(OVERLAY *ov, Uint32 lba, Uint8 *buf);
+bool     Overlay_Write(OVERLAY *ov, Uint32 lba, const Uint8 *buf);
+bool     Overlay_Commit(OVERLAY *ov, FILE *base);
+void     Overlay_Discard(OVERLAY *ov);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PREV_OVERLAY_H */
@@ -16,4 +16,5 @@ struct {
 } lp_buffer;
 
 void Printer_Reset(void);
+void Printer_MemorySnapShot_Capture(bool bSave);
 void Printer_IO_Handler(void);
@@ -6,4 +6,6 @@ void rtc_stop_pdown_request(void);
 
 void nvram_init(void);
 void nvram_checksum(int force);
-char * get_rtc_ram_info(void);
\ No newline at end of file
+char * get_rtc_ram_info(void);
+
+void RTC_MemorySnapShot_Capture(bool bSave);
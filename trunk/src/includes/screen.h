@@ -27,13 +27,15 @@ extern SDL_Surface *sdlscrn;
 void Screen_Init(void);
 void Screen_UnInit(void);
 void Screen_Pause(bool pause);
+void Screen_Refresh(void);
 void Screen_EnterFullScreen(void);
 void Screen_ReturnFromFullScreen(void);
 void Screen_ModeChanged(void);
 bool Update_StatusBar(void);
 void SDL_UpdateRects(SDL_Surface *screen, int numrects, SDL_Rect *rects);
 void SDL_UpdateRect(SDL_Surface *screen, Sint32 x, Sint32 y, Sint32 w, Sint32 h);
-void blitDimension(Uint32* vram, SDL_Texture* tex);
+void blitDimension(Uint32* vram, SDL_Texture* tex, const Uint32* dirty);
+bool Screen_SaveSnapshot(const char* filename);
 
 #ifdef __cplusplus
 }
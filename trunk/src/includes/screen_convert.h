@@ -0,0 +1,42 @@
+/*
+  Previous - screen_convert.h
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+*/
+
+#ifndef PREV_SCREEN_CONVERT_H
+#define PREV_SCREEN_CONVERT_H
+
+#include <SDL.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Destination pixel format of a conversion */
+typedef struct {
+    Uint32           format;
+    bool             rgb8;     /* 32 bit pixels with 8 bit color channels */
+    int              rShift;
+    int              gShift;
+    int              bShift;
+    Uint32           alpha;    /* alpha bits of an opaque pixel */
+    SDL_PixelFormat* pf;       /* used by the generic fallback only */
+} convert_format_t;
+
+void Convert_Init(Uint32 format);
+void Convert_SetFormat(convert_format_t* f, Uint32 format);
+void Convert_FreeFormat(convert_format_t* f);
+bool Convert_UseKernels(const char* name);
+
+void Convert_BW(Uint32* dst, const Uint8* src, int count);
+void Convert_Color(Uint32* dst, const Uint8* src, int count);
+void Convert_Dimension(const convert_format_t* f, Uint32* dst, const Uint32* src, int count);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* PREV_SCREEN_CONVERT_H */
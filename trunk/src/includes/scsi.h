@@ -18,25 +18,42 @@ struct {
 #define SCSI_CDB_MAX_SIZE 12
 
 
-/* This buffer temporarily stores data to be written to memory or disk */
+/* This buffer temporarily stores data to be written to memory or disk.
+ * Disk transfers are done in chunks of up to SCSI_BUFFER_SIZE bytes. */
+#define SCSI_BUFFER_SIZE 0x10000
 
 struct {
-    Uint8 data[512]; /* FIXME: BLOCKSIZE */
+    Uint8 data[SCSI_BUFFER_SIZE];
     int limit;
     int size;
     bool disk;
 } scsi_buffer;
 
 
+/* Disk access statistics per target */
+typedef struct {
+    Uint64 commands;
+    Uint64 bytes;
+    Uint64 syscalls;
+    Uint64 cache_hits;
+} SCSI_STATS;
+
+
 void SCSI_Init(void);
 void SCSI_Uninit(void);
 void SCSI_Reset(void);
 void SCSI_Insert(Uint8 target);
 void SCSI_Eject(Uint8 target);
+void SCSI_MemorySnapShot_Capture(bool bSave);
+void SCSI_GetStats(Uint8 target, SCSI_STATS *stats);
+bool SCSI_OverlayCommit(Uint8 target);
+bool SCSI_OverlayDiscard(Uint8 target);
+bool SCSI_OverlayPush(Uint8 target, const char *path);
 
 Uint8 SCSIdisk_Send_Status(void);
 Uint8 SCSIdisk_Send_Message(void);
 Uint8 SCSIdisk_Send_Data(void);
+int SCSIdisk_Send_Block(Uint8 *dst, int len);
 void SCSIdisk_Receive_Data(Uint8 val);
 bool SCSIdisk_Select(Uint8 target);
 void SCSIdisk_Receive_Command(Uint8 *commandbuf, Uint8 identify);
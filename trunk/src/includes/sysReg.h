@@ -61,6 +61,7 @@ int scr_get_interrupt_level(Uint32 interrupt);
 
 extern Uint32 scrIntStat;
 extern Uint32 scrIntMask;
+extern int    scrIntLevel;
 
 /**
  * Return interrupt number (1 - 7), 0 means no interrupt.
@@ -68,11 +69,10 @@ extern Uint32 scrIntMask;
  * due to the interrupt level field in the SR.
  */
 static inline int intlev(void) {
-    /* Poll interrupt level from interrupt status and mask registers
-     * --> see sysReg.c
+    /* The interrupt level is cached and only re-evaluated when the
+     * interrupt status or mask registers change --> see sysReg.c
      */
-    Uint32 interrupt = scrIntStat&scrIntMask;
-    return interrupt ? scr_get_interrupt_level(interrupt) : 0;
+    return scrIntLevel;
 }
 
 void set_dsp_interrupt(Uint8 state);
@@ -80,6 +80,7 @@ void set_dsp_interrupt(Uint8 state);
 void SID_Read(void);
 
 void SCR_Reset(void);
+void SCR_MemorySnapShot_Capture(bool bSave);
 void SCR1_Read0(void);
 void SCR1_Read1(void);
 void SCR1_Read2(void);
@@ -20,6 +20,7 @@
 #include "snd.h"
 #include "video.h"
 #include "host.h"
+#include "memorySnapShot.h"
 
 #define LOG_KMS_LEVEL LOG_DEBUG
 #define IO_SEG_MASK	0x1FFFF
@@ -560,3 +561,15 @@ void Mouse_Handler(void) {
         CycInt_AddRelativeInterruptUs((1000*1000)/MOUSE_STEP_FREQ, 0, INTERRUPT_MOUSE);
     }
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of KMS variables ('MemorySnapShot_Store' handles type)
+ */
+void KMS_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(&kms, sizeof(kms));
+    MemorySnapShot_Store(&km_address, sizeof(km_address));
+    MemorySnapShot_Store(&km_dev_msk, sizeof(km_dev_msk));
+}
@@ -16,6 +16,9 @@ const char M68000_fileid[] = "Hatari m68000.c : " __DATE__ " " __TIME__;
 #include "m68000.h"
 
 #include "mmu_common.h"
+#include "cpummu.h"
+#include "cpummu030.h"
+#include "memorySnapShot.h"
 
 Uint32 BusErrorAddress;         /* Stores the offending address for bus-/address errors */
 Uint32 BusErrorPC;              /* Value of the PC when bus error occurs */
@@ -27,6 +30,9 @@ int LastInstrCycles = 0;	/* number of cycles for previous instr. (not rounded to
 int Pairing = 0;		/* set to 1 if the latest 2 intr paired */
 char PairingArray[ MAX_OPCODE_FAMILY ][ MAX_OPCODE_FAMILY ];
 
+int nIdleLoopPCs;               /* Number of valid entries in IdleLoopPC */
+Uint32 IdleLoopPC[M68000_MAX_IDLE_LOOPS]; /* Addresses of guest idle loops */
+
 
 /* to convert the enum from OpcodeFamily to a readable value for pairing's debug */
 const char *OpcodeName[] = { "ILLG",
@@ -159,6 +165,24 @@ void M68000_Reset(bool bCold) {
 }
 
 
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of CPU variables ('MemorySnapShot_Store' handles type)
+ */
+void M68000_MemorySnapShot_Capture(bool bSave)
+{
+	m68k_MemorySnapShot_Capture(bSave);
+	mmu030_MemorySnapShot_Capture(bSave);
+	mmu_MemorySnapShot_Capture(bSave);
+
+	MemorySnapShot_Store(&BusErrorAddress, sizeof(BusErrorAddress));
+	MemorySnapShot_Store(&BusErrorPC, sizeof(BusErrorPC));
+	MemorySnapShot_Store(&bBusErrorReadWrite, sizeof(bBusErrorReadWrite));
+	MemorySnapShot_Store(&BusMode, sizeof(BusMode));
+	MemorySnapShot_Store(&pendingInterrupts, sizeof(pendingInterrupts));
+}
+
+
 /*-----------------------------------------------------------------------*/
 /**
  * Stop 680x0 emulation
@@ -179,6 +203,30 @@ void M68000_Start(void)
 }
 
 
+/*-----------------------------------------------------------------------*/
+/**
+ * Parse the comma separated list of idle loop addresses. When the CPU
+ * reaches one of them with no interrupt pending, the time until the
+ * next scheduled event is skipped.
+ */
+static void M68000_ParseIdleLoops(void)
+{
+	const char *s = ConfigureParams.System.szIdleLoopPCs;
+	char *end;
+
+	nIdleLoopPCs = 0;
+	while (*s && nIdleLoopPCs < M68000_MAX_IDLE_LOOPS) {
+		Uint32 pc = strtoul(s, &end, 16);
+		if (end == s) {
+			s++;
+			continue;
+		}
+		IdleLoopPC[nIdleLoopPCs++] = pc;
+		s = end;
+	}
+}
+
+
 /*-----------------------------------------------------------------------*/
 /**
  * Check whether CPU settings have been changed.
@@ -236,6 +284,8 @@ void M68000_CheckCpuSettings(void)
 	changed_prefs.fpu_strict = ConfigureParams.System.bCompatibleFPU;
 	changed_prefs.mmu_model = ConfigureParams.System.bMMU?changed_prefs.cpu_model:0;
 
+	M68000_ParseIdleLoops();
+
 	if (table68k)
 		check_prefs_changed_cpu();
 }
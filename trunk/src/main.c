@@ -31,12 +31,14 @@ const char Main_fileid[] = "Hatari main.c : " __DATE__ " " __TIME__;
 #include "audio.h"
 #include "debugui.h"
 #include "file.h"
+#include "diskio.h"
 #include "dsp.h"
 #include "host.h"
 #include "dimension.hpp"
 
 #include "hatari-glue.h"
 #include "NextBus.hpp"
+#include "memorySnapShot.h"
 
 #if HAVE_GETTIMEOFDAY
 #include <sys/time.h>
@@ -45,6 +47,15 @@ const char Main_fileid[] = "Hatari main.c : " __DATE__ " " __TIME__;
 int nFrameSkips;
 
 bool bQuitProgram = false;                /* Flag to quit program cleanly */
+bool bHeadless    = false;                /* Run without window and audio device */
+
+static int    nSnapshotInterval = 0;      /* Seconds between PNG snapshots, 0 = off */
+static char   szSnapshotDir[FILENAME_MAX] = ".";
+static Uint32 nSnapshotLast;
+static int    nSnapshotCount;
+static volatile sig_atomic_t bSnapshotRequest = 0;
+
+static char   szRestoreFile[FILENAME_MAX]; /* Memory snapshot to restore at start-up */
 
 static bool bEmulationActive = true;      /* Run emulation when started */
 static bool bAccurateDelays;              /* Host system has an accurate SDL_Delay()? */
@@ -165,7 +176,7 @@ bool Main_UnPauseEmulation(void) {
  * Optionally ask user whether to quit and set bQuitProgram accordingly
  */
 void Main_RequestQuit(void) {
-    if (ConfigureParams.Log.bConfirmQuit) {
+    if (ConfigureParams.Log.bConfirmQuit && !bHeadless) {
 		bQuitProgram = false;	/* if set true, dialog exits */
 		bQuitProgram = DlgAlert_Query("All unsaved data will be lost.\nDo you really want to quit?");
 	}
@@ -242,6 +253,36 @@ static void Main_HandleMouseMotion(SDL_Event *pEvent) {
 	}
 }
 
+/* ----------------------------------------------------------------------- */
+/**
+ * Save framebuffer snapshot if requested by signal or interval.
+ */
+static void Main_CheckSnapshot(void) {
+    char   name[32];
+    char*  path;
+    Uint32 now;
+    
+    if (!bSnapshotRequest && !nSnapshotInterval)
+        return;
+    
+    now = SDL_GetTicks();
+    if (!bSnapshotRequest && (now - nSnapshotLast) < (Uint32)nSnapshotInterval * 1000)
+        return;
+    
+    bSnapshotRequest = 0;
+    nSnapshotLast    = now;
+    
+    snprintf(name, sizeof(name), "previous_%05d", nSnapshotCount++);
+    path = File_MakePath(szSnapshotDir, name, ".png");
+    if (path) {
+        if (Screen_SaveSnapshot(path))
+            Log_Printf(LOG_WARN, "Screen snapshot saved to %s\n", path);
+        else
+            Log_Printf(LOG_WARN, "Could not save screen snapshot to %s\n", path);
+        free(path);
+    }
+}
+
 static int statusBarUpdate;
 
 /* ----------------------------------------------------------------------- */
@@ -270,9 +311,12 @@ void Main_EventHandler(void) {
         Main_Speed(rt, vt);
 #endif
         Statusbar_UpdateInfo();
+        File_SyncMaps(false);
         statusBarUpdate = 0;
     }
     
+    Main_CheckSnapshot();
+    
     do {
         bContinueProcessing = false;
         
@@ -313,6 +357,8 @@ void Main_EventHandler(void) {
                 if(event.window.event == SDL_WINDOWEVENT_CLOSE) {
                     SDL_WaitEventTimeout(&event, 100); // grab SDL_Quit if pending
                     Main_RequestQuit();
+                } else if(event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+                    Screen_Refresh();
                 }
                 continue;
 
@@ -393,6 +439,8 @@ void Main_EventHandlerInterrupt() {
  * Set Hatari window title. Use NULL for default
  */
 void Main_SetTitle(const char *title) {
+    if (!sdlWindow)
+        return;
     if (title)
         SDL_SetWindowTitle(sdlWindow, title);
     else
@@ -412,8 +460,9 @@ static void Main_Init(void) {
 	Log_Printf(LOG_INFO, PROG_NAME ", compiled on:  " __DATE__ ", " __TIME__ "\n");
 
 	/* Init SDL's video subsystem. Note: Audio and joystick subsystems
-	   will be initialized later (failures there are not fatal). */
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0)
+	   will be initialized later (failures there are not fatal).
+	   Headless mode only needs events and timers. */
+	if (SDL_Init((bHeadless ? SDL_INIT_EVENTS : SDL_INIT_VIDEO) | SDL_INIT_TIMER) < 0)
 	{
 		fprintf(stderr, "Could not initialize the SDL library:\n %s\n", SDL_GetError() );
 		exit(-1);
@@ -426,7 +475,8 @@ static void Main_Init(void) {
 	Keymap_Init();
 
     /* call menu at startup */
-    if (!File_Exists(sConfigFileName) || ConfigureParams.ConfigDialog.bShowConfigDialogAtStartup) {
+    if (!bHeadless &&
+        (!File_Exists(sConfigFileName) || ConfigureParams.ConfigDialog.bShowConfigDialogAtStartup)) {
         Dialog_DoProperty();
         if (bQuitProgram) {
             SDL_Quit();
@@ -462,7 +512,10 @@ static void Main_UnInit(void) {
 	IoMem_UnInit();
 	SDLGui_UnInit();
 	Screen_UnInit();
+	DSP_UnInit();
 	Exit680x0();
+	DiskIO_UnInit();
+	File_SyncMaps(true);
 
 	/* SDL uninit: */
 	SDL_Quit();
@@ -530,6 +583,16 @@ static void Main_StatusbarSetup(void) {
 	extern void Win_OpenCon(void);
 #endif
 
+/*-----------------------------------------------------------------------*/
+/**
+ * Request a screen snapshot (SIGUSR1)
+ */
+#ifndef _WIN32
+static void Main_SnapshotSignal(int sig) {
+    bSnapshotRequest = 1;
+}
+#endif
+
 /*-----------------------------------------------------------------------*/
 /**
  * Set signal handlers to catch signals
@@ -537,10 +600,42 @@ static void Main_StatusbarSetup(void) {
 static void Main_SetSignalHandlers(void) {
 #ifndef _WIN32
     signal(SIGPIPE, SIG_IGN);
+    signal(SIGUSR1, Main_SnapshotSignal);
 #endif
     signal(SIGFPE, SIG_IGN);
 }
 
+/*-----------------------------------------------------------------------*/
+/**
+ * Check command line for headless mode, snapshot and restore options. Other
+ * arguments (e.g. added by the OS when starting from a bundle) are ignored.
+ */
+static void Main_ParseArgs(int argc, char *argv[]) {
+    int i;
+    
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--headless")) {
+            bHeadless = true;
+        } else if (!strcmp(argv[i], "--snapshot-interval") && i+1 < argc) {
+            nSnapshotInterval = atoi(argv[++i]);
+            if (nSnapshotInterval < 0)
+                nSnapshotInterval = 0;
+        } else if (!strcmp(argv[i], "--snapshot-dir") && i+1 < argc) {
+            snprintf(szSnapshotDir, sizeof(szSnapshotDir), "%s", argv[++i]);
+        } else if (!strcmp(argv[i], "--restore") && i+1 < argc) {
+            snprintf(szRestoreFile, sizeof(szRestoreFile), "%s", argv[++i]);
+        } else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            printf("Usage: %s [options]\n"
+                   "  --headless                 run without window and audio output\n"
+                   "  --snapshot-interval <sec>  save framebuffer as PNG every <sec> seconds\n"
+                   "  --snapshot-dir <dir>       directory for PNG snapshots (default: .)\n"
+                   "  --restore <file>           restore machine state from memory snapshot\n"
+                   "Send SIGUSR1 to save a snapshot on request.\n", argv[0]);
+            exit(0);
+        }
+    }
+}
+
 
 /*-----------------------------------------------------------------------*/
 /**
@@ -557,6 +652,9 @@ int main(int argc, char *argv[]) {
 
 	/* Initialize directory strings */
 	Paths_Init(argv[0]);
+	
+	/* Check for headless mode */
+	Main_ParseArgs(argc, argv);
 
 	/* Set default configuration values: */
 	Configuration_SetDefault();
@@ -594,11 +692,21 @@ int main(int argc, char *argv[]) {
 	/* Check if SDL_Delay is accurate */
 	Main_CheckForAccurateDelays();
 
+	/* Restore machine state instead of booting from scratch */
+	if (szRestoreFile[0]) {
+		MemorySnapShot_Restore(szRestoreFile, false);
+	} else if (ConfigureParams.Memory.bAutoSave &&
+	           File_Exists(ConfigureParams.Memory.szMemoryCaptureFileName)) {
+		MemorySnapShot_Restore(ConfigureParams.Memory.szMemoryCaptureFileName, false);
+	}
 
 	/* Run emulation */
 	Main_UnPauseEmulation();
 	M68000_Start();                 /* Start emulation */
 
+	if (ConfigureParams.Memory.bAutoSave) {
+		MemorySnapShot_Capture(ConfigureParams.Memory.szMemoryCaptureFileName, false);
+	}
 
 	/* Un-init emulation system */
 	Main_UnInit();
@@ -0,0 +1,401 @@
+/*
+  Previous - memorySnapShot.c
+
+  This file is distributed under the GNU Public License, version 2 or at
+  your option any later version. Read the file gpl.txt for details.
+
+  Memory snapshot
+
+  This handles the saving/restoring of the emulator's state so any game or
+  application can be saved and restored at any time. Every module with
+  state has a function *_MemorySnapShot_Capture(bool bSave) which passes
+  its variables to MemorySnapShot_Store(). Depending on whether we are
+  saving or restoring, the data is written to or read from the snapshot
+  file. The order of the calls is the file format, so every change to a
+  capture function needs a new SNAPSHOT_VERSION.
+  Large memory areas are stored with MemorySnapShot_StorePages() which
+  skips pages containing only zeros. Disk images are not part of the
+  snapshot, they are referenced by the configuration stored in the file
+  and must be unchanged when the snapshot is restored.
+*/
+const char MemorySnapShot_fileid[] = "Previous memorySnapShot.c : " __DATE__ " " __TIME__;
+
+#include "main.h"
+#include "configuration.h"
+#include "memorySnapShot.h"
+#include "dialog.h"
+#include "file.h"
+#include "log.h"
+#include "reset.h"
+#include "statusbar.h"
+#include "host.h"
+#include "cycInt.h"
+#include "m68000.h"
+#include "sysReg.h"
+#include "rtcnvram.h"
+#include "tmc.h"
+#include "nbic.h"
+#include "bmap.h"
+#include "dma.h"
+#include "esp.h"
+#include "scsi.h"
+#include "mo.h"
+#include "floppy.h"
+#include "ethernet.h"
+#include "kms.h"
+#include "scc.h"
+#include "adb.h"
+#include "snd.h"
+#include "printer.h"
+#include "dsp.h"
+#include "NextBus.hpp"
+#include "memory.h"
+
+#if HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+
+#define SNAPSHOT_MAGIC      "PREVSNAP"
+#define SNAPSHOT_VERSION    3
+#define SNAPSHOT_PAGE_SIZE  0x10000
+
+#define SNAPSHOT_TAG_SIZE   8
+
+#if HAVE_LIBZ
+typedef gzFile MSS_File;
+#else
+typedef FILE*  MSS_File;
+#endif
+
+static MSS_File CaptureFile;
+static bool     bCaptureSave;
+static bool     bCaptureError;
+
+/* Modules in the order they are stored in the snapshot file. The machine
+ * configuration is handled separately because it is needed to set up the
+ * emulated machine before any of these can be restored. */
+static const struct {
+	const char tag[SNAPSHOT_TAG_SIZE+1];
+	void (*capture)(bool bSave);
+} SnapShotModules[] =
+{
+	{ "MEMORY  ", Memory_MemorySnapShot_Capture },
+	{ "CPU     ", M68000_MemorySnapShot_Capture },
+	{ "CYCINT  ", CycInt_MemorySnapShot_Capture },
+	{ "HOST    ", host_MemorySnapShot_Capture },
+	{ "SCR     ", SCR_MemorySnapShot_Capture },
+	{ "RTC     ", RTC_MemorySnapShot_Capture },
+	{ "TMC     ", TMC_MemorySnapShot_Capture },
+	{ "NBIC    ", NBIC_MemorySnapShot_Capture },
+	{ "BMAP    ", BMAP_MemorySnapShot_Capture },
+	{ "DMA     ", DMA_MemorySnapShot_Capture },
+	{ "ESP     ", ESP_MemorySnapShot_Capture },
+	{ "SCSI    ", SCSI_MemorySnapShot_Capture },
+	{ "MO      ", MO_MemorySnapShot_Capture },
+	{ "FLOPPY  ", Floppy_MemorySnapShot_Capture },
+	{ "ETHERNET", Ethernet_MemorySnapShot_Capture },
+	{ "KMS     ", KMS_MemorySnapShot_Capture },
+	{ "SCC     ", SCC_MemorySnapShot_Capture },
+	{ "ADB     ", ADB_MemorySnapShot_Capture },
+	{ "SOUND   ", Sound_MemorySnapShot_Capture },
+	{ "PRINTER ", Printer_MemorySnapShot_Capture },
+	{ "DSP     ", DSP_MemorySnapShot_Capture },
+	{ "NEXTBUS ", NextBus_MemorySnapShot_Capture },
+	{ "END     ", NULL }
+};
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Open/Create snapshot file, and set flag so 'MemorySnapShot_Store' knows
+ * how to handle data.
+ */
+static bool MemorySnapShot_OpenFile(const char *pszFileName, bool bSave)
+{
+	bCaptureSave  = bSave;
+	bCaptureError = false;
+
+#if HAVE_LIBZ
+	CaptureFile = gzopen(pszFileName, bSave ? "wb1" : "rb");
+#else
+	CaptureFile = fopen(pszFileName, bSave ? "wb" : "rb");
+#endif
+	return CaptureFile != NULL;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Close snapshot file.
+ */
+static void MemorySnapShot_CloseFile(void)
+{
+#if HAVE_LIBZ
+	if (gzclose(CaptureFile) != Z_OK)
+		bCaptureError = true;
+#else
+	if (fclose(CaptureFile))
+		bCaptureError = true;
+#endif
+	CaptureFile = NULL;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore data to/from file. Errors are remembered and all
+ * following calls are ignored.
+ */
+void MemorySnapShot_Store(void *pData, int Size)
+{
+	long nBytes;
+
+	if (bCaptureError || Size <= 0)
+		return;
+
+#if HAVE_LIBZ
+	if (bCaptureSave)
+		nBytes = gzwrite(CaptureFile, pData, Size);
+	else
+		nBytes = gzread(CaptureFile, pData, Size);
+#else
+	if (bCaptureSave)
+		nBytes = fwrite(pData, 1, Size, CaptureFile);
+	else
+		nBytes = fread(pData, 1, Size, CaptureFile);
+#endif
+
+	if (nBytes != Size)
+		bCaptureError = true;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore a large memory area. It is split into pages and pages
+ * containing only zeros are not written to the file.
+ */
+void MemorySnapShot_StorePages(void *pData, Uint32 Size)
+{
+	static const Uint8 ZeroPage[SNAPSHOT_PAGE_SIZE];
+	Uint8  *pPage;
+	Uint32 nPageSize;
+	Uint8  bUsed = 0;
+
+	for (pPage = pData; Size > 0; pPage += nPageSize, Size -= nPageSize)
+	{
+		nPageSize = Size < SNAPSHOT_PAGE_SIZE ? Size : SNAPSHOT_PAGE_SIZE;
+
+		if (bCaptureSave)
+			bUsed = memcmp(pPage, ZeroPage, nPageSize) != 0;
+		MemorySnapShot_Store(&bUsed, sizeof(bUsed));
+		if (bCaptureError)
+			return;
+
+		if (bUsed)
+			MemorySnapShot_Store(pPage, nPageSize);
+		else if (!bCaptureSave)
+			memset(pPage, 0, nPageSize);
+	}
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore a section tag. When restoring, the tag is compared
+ * to the expected one to detect damaged or incompatible files early.
+ */
+static void MemorySnapShot_Section(const char *pszTag)
+{
+	char szTag[SNAPSHOT_TAG_SIZE];
+
+	memcpy(szTag, pszTag, SNAPSHOT_TAG_SIZE);
+	MemorySnapShot_Store(szTag, SNAPSHOT_TAG_SIZE);
+
+	if (!bCaptureSave && !bCaptureError && memcmp(szTag, pszTag, SNAPSHOT_TAG_SIZE))
+	{
+		Log_Printf(LOG_WARN, "Memory snapshot: section '%.8s' expected, found '%.8s'\n",
+		           pszTag, szTag);
+		bCaptureError = true;
+	}
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore file header. The snapshot contains raw host structures,
+ * so it can only be restored by the same version of the emulator running
+ * on a host with the same pointer size.
+ */
+static void MemorySnapShot_Header(void)
+{
+	char   szMagic[SNAPSHOT_TAG_SIZE];
+	char   szVersion[32];
+	Uint32 nVersion  = SNAPSHOT_VERSION;
+	Uint32 nPtrSize  = sizeof(void*);
+
+	memcpy(szMagic, SNAPSHOT_MAGIC, SNAPSHOT_TAG_SIZE);
+	memset(szVersion, 0, sizeof(szVersion));
+	strncpy(szVersion, PROG_NAME, sizeof(szVersion)-1);
+
+	MemorySnapShot_Store(szMagic, sizeof(szMagic));
+	MemorySnapShot_Store(szVersion, sizeof(szVersion));
+	MemorySnapShot_Store(&nVersion, sizeof(nVersion));
+	MemorySnapShot_Store(&nPtrSize, sizeof(nPtrSize));
+
+	if (bCaptureSave || bCaptureError)
+		return;
+
+	if (memcmp(szMagic, SNAPSHOT_MAGIC, SNAPSHOT_TAG_SIZE))
+	{
+		Log_Printf(LOG_WARN, "Memory snapshot: not a snapshot file\n");
+		bCaptureError = true;
+	}
+	else if (strncmp(szVersion, PROG_NAME, sizeof(szVersion)) ||
+	         nVersion != SNAPSHOT_VERSION || nPtrSize != sizeof(void*))
+	{
+		szVersion[sizeof(szVersion)-1] = '\0';
+		Log_Printf(LOG_WARN, "Memory snapshot: incompatible file (%s, version %d, %d-bit)\n",
+		           szVersion, nVersion, nPtrSize*8);
+		bCaptureError = true;
+	}
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore all emulated modules.
+ */
+static void MemorySnapShot_Modules(bool bSave)
+{
+	int i;
+
+	for (i = 0; SnapShotModules[i].capture && !bCaptureError; i++)
+	{
+		MemorySnapShot_Section(SnapShotModules[i].tag);
+		SnapShotModules[i].capture(bSave);
+	}
+	MemorySnapShot_Section(SnapShotModules[i].tag);
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save 'snapshot' of memory/chips/emulation variables
+ */
+bool MemorySnapShot_Capture(const char *pszFileName, bool bConfirm)
+{
+	bool bPaused;
+
+	/* Ask before overwriting an existing file */
+	if (bConfirm && !File_QueryOverwrite(pszFileName))
+		return false;
+
+	if (!MemorySnapShot_OpenFile(pszFileName, true))
+	{
+		Log_Printf(LOG_WARN, "Memory snapshot: cannot create '%s'\n", pszFileName);
+		if (bConfirm)
+			DlgAlert_Notice("Unable to save memory state to file.");
+		return false;
+	}
+
+	bPaused = Main_PauseEmulation(false);
+
+	MemorySnapShot_Header();
+	MemorySnapShot_Section("CONFIG  ");
+	Configuration_MemorySnapShot_Capture(true);
+	MemorySnapShot_Modules(true);
+
+	MemorySnapShot_CloseFile();
+
+	if (bPaused)
+		Main_UnPauseEmulation();
+
+	if (bCaptureError)
+	{
+		Log_Printf(LOG_WARN, "Memory snapshot: error writing '%s'\n", pszFileName);
+		if (bConfirm)
+			DlgAlert_Notice("Unable to save memory state to file.");
+		return false;
+	}
+
+	Log_Printf(LOG_WARN, "Memory snapshot: saved to '%s'\n", pszFileName);
+	if (bConfirm)
+		DlgAlert_Notice("Memory state file saved.");
+	return true;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Restore 'snapshot' of memory/chips/emulation variables. The machine is
+ * first reset with the configuration stored in the snapshot and then all
+ * modules are restored on top of it.
+ */
+bool MemorySnapShot_Restore(const char *pszFileName, bool bConfirm)
+{
+	CNF_PARAMS current;
+	bool bPaused;
+
+	if (!MemorySnapShot_OpenFile(pszFileName, false))
+	{
+		Log_Printf(LOG_WARN, "Memory snapshot: cannot open '%s'\n", pszFileName);
+		if (bConfirm)
+			DlgAlert_Notice("Unable to restore memory state from file.");
+		return false;
+	}
+
+	bPaused = Main_PauseEmulation(false);
+
+	/* Restore machine configuration and set up the emulated machine */
+	current = ConfigureParams;
+	MemorySnapShot_Header();
+	MemorySnapShot_Section("CONFIG  ");
+	Configuration_MemorySnapShot_Capture(false);
+
+	if (bCaptureError)
+	{
+		MemorySnapShot_CloseFile();
+		ConfigureParams = current;
+	}
+	else
+	{
+		Configuration_Apply(true);
+		Reset_Cold();
+
+		MemorySnapShot_Modules(false);
+		MemorySnapShot_CloseFile();
+
+		if (bCaptureError)
+		{
+			/* State is undefined now, start over with the old configuration */
+			ConfigureParams = current;
+			Configuration_Apply(true);
+			Reset_Cold();
+		}
+		else if (!CycInt_InterruptActive(INTERRUPT_EVENT_LOOP))
+		{
+			/* Snapshots saved from the event handler have no pending event loop */
+			CycInt_AddRelativeInterruptUs((1000*1000)/200, 0, INTERRUPT_EVENT_LOOP);
+		}
+	}
+
+	Statusbar_UpdateInfo();
+
+	if (bPaused)
+		Main_UnPauseEmulation();
+
+	if (bCaptureError)
+	{
+		Log_Printf(LOG_WARN, "Memory snapshot: error restoring '%s'\n", pszFileName);
+		if (bConfirm)
+			DlgAlert_Notice("Unable to restore memory state from file.");
+		return false;
+	}
+
+	Log_Printf(LOG_WARN, "Memory snapshot: restored from '%s'\n", pszFileName);
+	if (bConfirm)
+		DlgAlert_Notice("Memory state file restored.");
+	return true;
+}
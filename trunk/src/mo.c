@@ -26,8 +26,10 @@
 #include "dma.h"
 #include "floppy.h"
 #include "file.h"
+#include "diskio.h"
 #include "rs.h"
 #include "statusbar.h"
+#include "memorySnapShot.h"
 
 
 #define LOG_MO_REG_LEVEL    LOG_DEBUG
@@ -73,6 +75,7 @@ struct {
     Uint32 sec_offset;
     
     FILE* dsk;
+    Uint8* map; /* memory mapped image, NULL if not mapped */
     
     bool spinning;
     bool spiraling;
@@ -1028,7 +1031,7 @@ void mo_read_sector(Uint32 sector_id) {
     Log_Printf(LOG_MO_IO_LEVEL, "MO disk %i: Read sector at offset %i (%i sectors remaining)",
                dnum, sector_num, sector_counter-1);
     
-    File_Read(ecc_buffer[eccin].data, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
+    DiskIO_Read(modrv[dnum].map, ecc_buffer[eccin].data, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
     
     ecc_buffer[eccin].limit = ecc_buffer[eccin].size = MO_SECTORSIZE_DISK;
 }
@@ -1040,7 +1043,7 @@ void mo_write_sector(Uint32 sector_id) {
                dnum, sector_num, sector_counter-1);
     
     if (ecc_buffer[eccout].limit==MO_SECTORSIZE_DISK) {
-        File_Write(ecc_buffer[eccout].data, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
+        DiskIO_Write(modrv[dnum].map, ecc_buffer[eccout].data, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
 
         ecc_buffer[eccout].size = 0;
         ecc_buffer[eccout].limit = MO_SECTORSIZE_DATA;
@@ -1060,7 +1063,7 @@ void mo_erase_sector(Uint32 sector_id) {
     Uint8 erase_buf[MO_SECTORSIZE_DISK];
     memset(erase_buf, 0xFF, MO_SECTORSIZE_DISK);
     
-    File_Write(erase_buf, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
+    DiskIO_Write(modrv[dnum].map, erase_buf, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
 }
 
 void mo_verify_sector(Uint32 sector_id) {
@@ -1069,7 +1072,7 @@ void mo_verify_sector(Uint32 sector_id) {
     Log_Printf(LOG_MO_IO_LEVEL, "MO disk %i: Verify sector at offset %i (%i sectors remaining)",
                dnum, sector_num, sector_counter-1);
     
-    File_Read(ecc_buffer[eccin].data, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
+    DiskIO_Read(modrv[dnum].map, ecc_buffer[eccin].data, MO_SECTORSIZE_DISK, sector_num*MO_SECTORSIZE_DISK, modrv[dnum].dsk);
     
     ecc_buffer[eccin].limit = ecc_buffer[eccin].size = MO_SECTORSIZE_DISK;
 }
@@ -1488,6 +1491,11 @@ void mo_eject_disk(int drv) {
 
     Log_Printf(LOG_WARN, "MO disk %i: Eject",drv);
     
+    File_Unmap(modrv[drv].map);
+    modrv[drv].map=NULL;
+    if (modrv[drv].dsk && !DiskIO_Flush(modrv[drv].dsk, true)) {
+        Log_Printf(LOG_WARN, "MO disk %i: Writing image file failed",drv);
+    }
     File_Close(modrv[drv].dsk);
     modrv[drv].dsk=NULL;
     modrv[drv].inserted=false;
@@ -1535,6 +1543,10 @@ void mo_insert_disk(int drv) {
         }
     }
 
+    if (ConfigureParams.System.bMapDiskImages) {
+        modrv[drv].map = File_Map(modrv[drv].dsk, !modrv[drv].protected);
+    }
+
     Statusbar_AddMessage("Inserting magneto-optical disk.", 0);
     modrv[drv].dstat&=~DS_EMPTY;
     modrv[drv].dstat|=DS_INSERT;
@@ -1749,6 +1761,9 @@ void MO_Init(void) {
                         modrv[i].protected=false;
                     }
                 }
+                if (modrv[i].dsk && ConfigureParams.System.bMapDiskImages) {
+                    modrv[i].map = File_Map(modrv[i].dsk, !modrv[i].protected);
+                }
             } else {
                 modrv[i].dsk = NULL;
                 modrv[i].inserted=false;
@@ -1767,9 +1782,19 @@ void MO_Init(void) {
 }
 
 void MO_Uninit(void) {
-    if (modrv[0].dsk)
+    File_Unmap(modrv[0].map);
+    File_Unmap(modrv[1].map);
+    modrv[0].map = modrv[1].map = NULL;
+    if (modrv[0].dsk) {
+        if (!DiskIO_Flush(modrv[0].dsk, true)) {
+            Log_Printf(LOG_WARN, "MO disk 0: Writing image file failed");
+        }
         File_Close(modrv[0].dsk);
+    }
     if (modrv[1].dsk) {
+        if (!DiskIO_Flush(modrv[1].dsk, true)) {
+            Log_Printf(LOG_WARN, "MO disk 1: Writing image file failed");
+        }
         File_Close(modrv[1].dsk);
     }
     modrv[0].dsk = modrv[1].dsk = NULL;
@@ -1793,3 +1818,46 @@ void MO_Reset(void) {
     MO_Uninit();
     MO_Init();
 }
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of MO variables ('MemorySnapShot_Store' handles type)
+ */
+void MO_MemorySnapShot_Capture(bool bSave) {
+    int i;
+    
+    MemorySnapShot_Store(&mo, sizeof(mo));
+    MemorySnapShot_Store(&sector_counter, sizeof(sector_counter));
+    MemorySnapShot_Store(&dnum, sizeof(dnum));
+    MemorySnapShot_Store(&sector_increment, sizeof(sector_increment));
+    MemorySnapShot_Store(&ecc_mode, sizeof(ecc_mode));
+    MemorySnapShot_Store(&ecc_state, sizeof(ecc_state));
+    MemorySnapShot_Store(&fmt_mode, sizeof(fmt_mode));
+    MemorySnapShot_Store(&write_timing, sizeof(write_timing));
+    MemorySnapShot_Store(&sector_timer, sizeof(sector_timer));
+    MemorySnapShot_Store(&ecc_repeat, sizeof(ecc_repeat));
+    MemorySnapShot_Store(&eccin, sizeof(eccin));
+    MemorySnapShot_Store(&eccout, sizeof(eccout));
+    MemorySnapShot_Store(ecc_buffer, sizeof(ecc_buffer));
+    MemorySnapShot_Store(&old_size, sizeof(old_size));
+    MemorySnapShot_Store(&delayed_compl, sizeof(delayed_compl));
+    MemorySnapShot_Store(&delayed_attn, sizeof(delayed_attn));
+    MemorySnapShot_Store(&delayed_drive, sizeof(delayed_drive));
+    
+    /* Media state comes from the configuration, keep it from MO_Reset() */
+    for (i = 0; i < MO_MAX_DRIVES; i++) {
+        FILE* dsk       = modrv[i].dsk;
+        Uint8* map      = modrv[i].map;
+        bool  protect   = modrv[i].protected;
+        bool  inserted  = modrv[i].inserted;
+        bool  connected = modrv[i].connected;
+        
+        MemorySnapShot_Store(&modrv[i], sizeof(modrv[i]));
+        
+        modrv[i].dsk       = dsk;
+        modrv[i].map       = map;
+        modrv[i].protected = protect;
+        modrv[i].inserted  = inserted;
+        modrv[i].connected = connected;
+    }
+}
@@ -3,6 +3,7 @@
 #include "m68000.h"
 #include "sysdeps.h"
 #include "nbic.h"
+#include "memorySnapShot.h"
 
 #define LOG_NEXTBUS_LEVEL   LOG_NONE
 
@@ -354,4 +355,11 @@ void nb_cpu_slot_bput(Uint32 addr, Uint8 b) {
 }
 
 
-
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of NBIC variables ('MemorySnapShot_Store' handles type)
+ */
+void NBIC_MemorySnapShot_Capture(bool bSave)
+{
+	MemorySnapShot_Store(&nbic, sizeof(nbic));
+}
@@ -0,0 +1,324 @@
+/*
+  Previous - overlay.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Copy-on-write overlays for disk images. Written blocks are stored in a
+  separate overlay file, the disk image itself is never modified. Overlays
+  can be stacked: the parent of an overlay is either the disk image or
+  another overlay file.
+
+  File format (all numbers little-endian):
+  - Header, OVERLAY_HEADER_SIZE bytes:
+      0: magic "PREVOVL\0"
+      8: version (32 bit)
+     12: block size (32 bit)
+     16: number of blocks of the disk (64 bit)
+     24: path of the parent overlay, empty if the parent is the disk image
+  - Index, one 32 bit entry per block: data slot + 1, 0 if the block is
+    not present in this overlay. The index is padded to OVERLAY_ALIGN.
+  - Data slots of OVERLAY_BLOCKSIZE bytes in the order they were written.
+  Index and data are page aligned so the file can be mapped directly.
+  The number of used slots is derived from the file size. A data slot is
+  always written before the index entry that refers to it.
+*/
+
+const char Overlay_fileid[] = "Previous overlay.c : " __DATE__ " " __TIME__;
+
+#include <unistd.h>
+
+#include "main.h"
+#include "file.h"
+#include "log.h"
+#include "overlay.h"
+
+#define OVERLAY_MAGIC       "PREVOVL"
+#define OVERLAY_VERSION     1
+#define OVERLAY_HEADER_SIZE 4096
+#define OVERLAY_PATH_MAX    1024
+#define OVERLAY_ALIGN       4096
+#define OVERLAY_MAX_DEPTH   16
+
+
+static Uint64 overlay_data_offset(Uint32 blocks) {
+    Uint64 size = OVERLAY_HEADER_SIZE + (Uint64)blocks * sizeof(Uint32);
+
+    return (size + OVERLAY_ALIGN - 1) & ~(Uint64)(OVERLAY_ALIGN - 1);
+}
+
+static OVERLAY* overlay_alloc(const char *path, Uint32 blocks) {
+    OVERLAY* ov = calloc(1, sizeof(OVERLAY));
+
+    if (!ov) {
+        return NULL;
+    }
+    ov->blocks = blocks;
+    ov->data   = overlay_data_offset(blocks);
+    ov->index  = calloc(blocks ? blocks : 1, sizeof(Uint32));
+    if (path) {
+        ov->path = strdup(path);
+    }
+    if (!ov->index || (path && !ov->path)) {
+        Overlay_Close(ov);
+        return NULL;
+    }
+    return ov;
+}
+
+/* Write a new header and an empty index */
+static bool overlay_create(OVERLAY *ov, const char *parent) {
+    Uint8 header[OVERLAY_HEADER_SIZE];
+    Uint32 val32;
+    Uint64 val64;
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, OVERLAY_MAGIC, sizeof(OVERLAY_MAGIC));
+    val32 = SDL_SwapLE32(OVERLAY_VERSION);
+    memcpy(header + 8, &val32, 4);
+    val32 = SDL_SwapLE32(OVERLAY_BLOCKSIZE);
+    memcpy(header + 12, &val32, 4);
+    val64 = SDL_SwapLE64(ov->blocks);
+    memcpy(header + 16, &val64, 8);
+    if (parent) {
+        strncpy((char*)header + 24, parent, OVERLAY_PATH_MAX - 1);
+    }
+
+    if (ftruncate(fileno(ov->fp), 0) || ftruncate(fileno(ov->fp), ov->data)) {
+        return false;
+    }
+    return File_Write(header, sizeof(header), 0, ov->fp);
+}
+
+/* Read header and index of an existing overlay file */
+static bool overlay_load(OVERLAY *ov, char *parent) {
+    Uint8 header[OVERLAY_HEADER_SIZE];
+    Uint32 val32, i;
+    Uint64 val64;
+    off_t size;
+
+    if (!File_Read(header, sizeof(header), 0, ov->fp)) {
+        return false;
+    }
+    if (memcmp(header, OVERLAY_MAGIC, sizeof(OVERLAY_MAGIC))) {
+        Log_Printf(LOG_WARN, "Overlay %s: Not an overlay file\n", ov->path);
+        return false;
+    }
+    memcpy(&val32, header + 8, 4);
+    if (SDL_SwapLE32(val32) != OVERLAY_VERSION) {
+        Log_Printf(LOG_WARN, "Overlay %s: Unsupported version %d\n", ov->path, SDL_SwapLE32(val32));
+        return false;
+    }
+    memcpy(&val32, header + 12, 4);
+    memcpy(&val64, header + 16, 8);
+    if (SDL_SwapLE32(val32) != OVERLAY_BLOCKSIZE || SDL_SwapLE64(val64) != ov->blocks) {
+        Log_Printf(LOG_WARN, "Overlay %s: Does not match disk size\n", ov->path);
+        return false;
+    }
+    memcpy(parent, header + 24, OVERLAY_PATH_MAX);
+    parent[OVERLAY_PATH_MAX - 1] = '\0';
+
+    if (ov->blocks && !File_Read((Uint8*)ov->index, ov->blocks * sizeof(Uint32), OVERLAY_HEADER_SIZE, ov->fp)) {
+        return false;
+    }
+    for (i = 0; i < ov->blocks; i++) {
+        ov->index[i] = SDL_SwapLE32(ov->index[i]);
+    }
+
+    size = File_Length(ov->path);
+    if (size > (off_t)ov->data) {
+        ov->used = (size - ov->data) / OVERLAY_BLOCKSIZE;
+    }
+    for (i = 0; i < ov->blocks; i++) {
+        if (ov->index[i] > ov->used) { /* slot was never completely written */
+            ov->index[i] = 0;
+        }
+    }
+    return true;
+}
+
+static OVERLAY* overlay_open(const char *path, Uint32 blocks, bool create, int depth) {
+    char parent[OVERLAY_PATH_MAX];
+    OVERLAY* ov;
+
+    if (depth > OVERLAY_MAX_DEPTH) {
+        Log_Printf(LOG_WARN, "Overlay %s: Too many stacked overlays\n", path);
+        return NULL;
+    }
+
+    ov = overlay_alloc(path, blocks);
+    if (!ov) {
+        return NULL;
+    }
+
+    if (!path) {
+        ov->fp = tmpfile();
+        if (ov->fp && overlay_create(ov, NULL)) {
+            return ov;
+        }
+    } else if (File_Exists(path)) {
+        ov->fp = File_Open(path, "rb+");
+        if (ov->fp && overlay_load(ov, parent)) {
+            if (parent[0] == '\0') {
+                return ov;
+            }
+            ov->parent = overlay_open(parent, blocks, false, depth + 1);
+            if (ov->parent) {
+                return ov;
+            }
+        }
+    } else if (create) {
+        ov->fp = File_Open(path, "wb+");
+        if (ov->fp && overlay_create(ov, NULL)) {
+            return ov;
+        }
+    }
+
+    Log_Printf(LOG_WARN, "Overlay %s: Cannot open overlay file\n", path ? path : "(temporary)");
+    Overlay_Close(ov);
+    return NULL;
+}
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Open overlay file and its parents, create it if it does not exist.
+ * A NULL path creates a temporary overlay that is removed when closed.
+ */
+OVERLAY* Overlay_Open(const char *path, Uint32 blocks) {
+    if (path && path[0] == '\0') {
+        path = NULL;
+    }
+    return overlay_open(path, blocks, true, 0);
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Create a new overlay on top of the given one. Further writes go to the
+ * new overlay, the given one is kept unchanged as a snapshot. Temporary
+ * overlays can not be stacked because they have no path.
+ */
+OVERLAY* Overlay_Push(OVERLAY *ov, const char *path) {
+    OVERLAY* top;
+
+    if (!ov->path || !path || path[0] == '\0' || File_Exists(path)) {
+        Log_Printf(LOG_WARN, "Overlay: Cannot create %s on top of %s\n",
+                   path ? path : "(temporary)", ov->path ? ov->path : "(temporary)");
+        return NULL;
+    }
+
+    top = overlay_alloc(path, ov->blocks);
+    if (!top) {
+        return NULL;
+    }
+    top->fp = File_Open(path, "wb+");
+    if (!top->fp || !overlay_create(top, ov->path)) {
+        Overlay_Close(top);
+        return NULL;
+    }
+    top->parent = ov;
+    return top;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Close overlay and all of its parents.
+ */
+void Overlay_Close(OVERLAY *ov) {
+    OVERLAY* parent;
+
+    while (ov) {
+        parent = ov->parent;
+        File_Close(ov->fp);
+        free(ov->index);
+        free(ov->path);
+        free(ov);
+        ov = parent;
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Read a block from the topmost overlay that contains it. Returns false
+ * if no overlay contains the block, it has to be read from the disk image.
+ */
+bool Overlay_Read(OVERLAY *ov, Uint32 lba, Uint8 *buf) {
+    for (; ov; ov = ov->parent) {
+        if (lba < ov->blocks && ov->index[lba]) {
+            return File_Read(buf, OVERLAY_BLOCKSIZE, ov->data + (Uint64)(ov->index[lba] - 1) * OVERLAY_BLOCKSIZE, ov->fp);
+        }
+    }
+    return false;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Write a block to the overlay. Parents are never modified.
+ */
+bool Overlay_Write(OVERLAY *ov, Uint32 lba, const Uint8 *buf) {
+    Uint32 slot, entry;
+
+    if (lba >= ov->blocks) {
+        return false;
+    }
+    slot = ov->index[lba];
+    if (slot) {
+        return File_Write((Uint8*)buf, OVERLAY_BLOCKSIZE, ov->data + (Uint64)(slot - 1) * OVERLAY_BLOCKSIZE, ov->fp);
+    }
+
+    slot = ov->used + 1;
+    if (!File_Write((Uint8*)buf, OVERLAY_BLOCKSIZE, ov->data + (Uint64)(slot - 1) * OVERLAY_BLOCKSIZE, ov->fp)) {
+        return false;
+    }
+    entry = SDL_SwapLE32(slot);
+    if (!File_Write((Uint8*)&entry, sizeof(entry), OVERLAY_HEADER_SIZE + (Uint64)lba * sizeof(Uint32), ov->fp)) {
+        return false;
+    }
+    ov->used = slot;
+    ov->index[lba] = slot;
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Merge the overlay into its parent, or into the disk image if it has no
+ * parent overlay. The overlay is empty afterwards.
+ */
+bool Overlay_Commit(OVERLAY *ov, FILE *base) {
+    Uint8 block[OVERLAY_BLOCKSIZE];
+    Uint32 lba;
+    bool ok = true;
+
+    for (lba = 0; lba < ov->blocks && ok; lba++) {
+        if (!ov->index[lba]) {
+            continue;
+        }
+        ok = File_Read(block, OVERLAY_BLOCKSIZE, ov->data + (Uint64)(ov->index[lba] - 1) * OVERLAY_BLOCKSIZE, ov->fp);
+        if (ok) {
+            if (ov->parent) {
+                ok = Overlay_Write(ov->parent, lba, block);
+            } else {
+                ok = base && File_Write(block, OVERLAY_BLOCKSIZE, (Uint64)lba * OVERLAY_BLOCKSIZE, base);
+            }
+        }
+    }
+    if (ok) {
+        Overlay_Discard(ov);
+    } else {
+        Log_Printf(LOG_WARN, "Overlay %s: Commit failed at block %d\n", ov->path ? ov->path : "(temporary)", lba);
+    }
+    return ok;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Drop all blocks written to the overlay. Parents are not changed.
+ */
+void Overlay_Discard(OVERLAY *ov) {
+    memset(ov->index, 0, ov->blocks * sizeof(Uint32));
+    ov->used = 0;
+    if (ftruncate(fileno(ov->fp), OVERLAY_HEADER_SIZE) ||
+        ftruncate(fileno(ov->fp), ov->data)) {
+        Log_Printf(LOG_WARN, "Overlay %s: Cannot truncate overlay file\n", ov->path ? ov->path : "(temporary)");
+    }
+}
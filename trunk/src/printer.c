@@ -16,6 +16,7 @@
 #include "dma.h"
 #include "statusbar.h"
 #include "file.h"
+#include "memorySnapShot.h"
 
 #if HAVE_LIBPNG
 #include <png.h>
@@ -770,3 +771,16 @@ void lp_png_finish(void) {
     }
 #endif
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of printer variables ('MemorySnapShot_Store' handles type)
+ */
+void Printer_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(&nlp, sizeof(nlp));
+    MemorySnapShot_Store(&lp_data_transfer, sizeof(lp_data_transfer));
+    MemorySnapShot_Store(&lp_copyright_sequence, sizeof(lp_copyright_sequence));
+    MemorySnapShot_Store(&lp_serial_phase, sizeof(lp_serial_phase));
+}
@@ -16,6 +16,7 @@
 #include "dimension.hpp"
 #include "sysReg.h"
 #include "rtcnvram.h"
+#include "memorySnapShot.h"
 
 #include <time.h>
 
@@ -1034,3 +1035,17 @@ char * get_rtc_ram_info(void) {
     return rtc_ram_info;
 }
 #endif
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of real time clock and NVRAM variables ('MemorySnapShot_Store' handles type)
+ */
+void RTC_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(&rtc, sizeof(rtc));
+    MemorySnapShot_Store(&newrtc, sizeof(newrtc));
+    MemorySnapShot_Store(&rtc_addr, sizeof(rtc_addr));
+    MemorySnapShot_Store(&rtc_val, sizeof(rtc_val));
+    MemorySnapShot_Store(&phase, sizeof(phase));
+}
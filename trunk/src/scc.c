@@ -16,6 +16,7 @@
 #include "scc.h"
 #include "sysReg.h"
 #include "dma.h"
+#include "memorySnapShot.h"
 
 #define IO_SEG_MASK	0x1FFFF
 
@@ -260,3 +261,14 @@ void scc_write_master_intr_reset(Uint8 val) {
 			break;
 	}
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of SCC variables ('MemorySnapShot_Store' handles type)
+ */
+void SCC_MemorySnapShot_Capture(bool bSave)
+{
+	MemorySnapShot_Store(scc, sizeof(scc));
+	MemorySnapShot_Store(&scc_register_pointer, sizeof(scc_register_pointer));
+}
@@ -0,0 +1,424 @@
+/*
+  Previous - screen_convert.c
+
+  This file is distributed under the GNU Public License, version 2 or at your
+  option any later version. Read the file gpl.txt for details.
+
+  Conversion of the NeXT framebuffer formats to host texture pixels:
+  - BW:        2 bit per pixel, 4 pixels per byte
+  - Color:     4 bit per channel, big-endian RGBx
+  - Dimension: 8 bit per channel, see blitDimension()
+
+  Destination formats with 8 bit channels are converted with shifts instead
+  of lookup tables. SSE2, AVX2 or NEON kernels are selected at runtime, with
+  scalar code for the remaining pixels and for other hosts.
+*/
+
+const char ScreenConvert_fileid[] = "Previous screen_convert.c : " __DATE__ " " __TIME__;
+
+#include "main.h"
+#include "log.h"
+#include "screen_convert.h"
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CONVERT_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define CONVERT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CONVERT_TARGET(isa)
+#endif
+
+/* Position of the channels in a host-order Dimension pixel */
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+#define ND_R_SHIFT 8
+#define ND_G_SHIFT 16
+#define ND_B_SHIFT 24
+#else
+#define ND_R_SHIFT 16
+#define ND_G_SHIFT 8
+#define ND_B_SHIFT 0
+#endif
+
+static Uint32           BW2RGB[0x400];
+static Uint32           COL2RGB[0x10000];  /* only for formats without 8 bit channels */
+static convert_format_t fbFormat;          /* format of the main framebuffer texture */
+
+typedef void (*convert_bw_t)(Uint32* dst, const Uint8* src, int count);
+typedef void (*convert_color_t)(const convert_format_t* f, Uint32* dst, const Uint8* src, int count);
+typedef void (*convert_dimension_t)(const convert_format_t* f, Uint32* dst, const Uint32* src, int count);
+
+static convert_bw_t        convertBW;
+static convert_color_t     convertColor;
+static convert_dimension_t convertDimension;
+
+
+/* **** Scalar kernels **** */
+
+static void bw_scalar(Uint32* dst, const Uint8* src, int count) {
+    for (int i = 0; i < count; i++) {
+        const Uint32* p = &BW2RGB[src[i] * 4];
+        *dst++ = p[0];
+        *dst++ = p[1];
+        *dst++ = p[2];
+        *dst++ = p[3];
+    }
+}
+
+static void color_table(const convert_format_t* f, Uint32* dst, const Uint8* src, int count) {
+    for (int i = 0; i < count; i++, src += 2)
+        *dst++ = COL2RGB[(src[0] << 8) | src[1]];
+}
+
+static void color_scalar(const convert_format_t* f, Uint32* dst, const Uint8* src, int count) {
+    for (int i = 0; i < count; i++, src += 2) {
+        Uint32 r = (src[0] >> 4)  * 0x11;
+        Uint32 g = (src[0] & 0xF) * 0x11;
+        Uint32 b = (src[1] >> 4)  * 0x11;
+        *dst++   = (r << f->rShift) | (g << f->gShift) | (b << f->bShift) | f->alpha;
+    }
+}
+
+static void dimension_mapRGB(const convert_format_t* f, Uint32* dst, const Uint32* src, int count) {
+    for (int i = 0; i < count; i++) {
+        Uint32 v = *src++;
+        *dst++   = SDL_MapRGB(f->pf, (v >> ND_R_SHIFT) & 0xFF, (v >> ND_G_SHIFT) & 0xFF, (v >> ND_B_SHIFT) & 0xFF);
+    }
+}
+
+static void dimension_scalar(const convert_format_t* f, Uint32* dst, const Uint32* src, int count) {
+    for (int i = 0; i < count; i++) {
+        Uint32 v = *src++;
+        *dst++   = (((v >> ND_R_SHIFT) & 0xFF) << f->rShift) |
+                   (((v >> ND_G_SHIFT) & 0xFF) << f->gShift) |
+                   (((v >> ND_B_SHIFT) & 0xFF) << f->bShift) | f->alpha;
+    }
+}
+
+
+#if CONVERT_X86
+/* **** SSE2 kernels **** */
+
+CONVERT_TARGET("sse2")
+static void bw_sse2(Uint32* dst, const Uint8* src, int count) {
+    for (int i = 0; i < count; i++, dst += 4)
+        _mm_storeu_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)&BW2RGB[src[i] * 4]));
+}
+
+/* x holds 4 color pixels as read from memory, zero extended to 32 bit */
+CONVERT_TARGET("sse2")
+static inline __m128i color4_sse2(__m128i x, __m128i rs, __m128i gs, __m128i bs, __m128i a) {
+    const __m128i m = _mm_set1_epi32(0xF);
+    __m128i r = _mm_and_si128(_mm_srli_epi32(x, 4), m);
+    __m128i g = _mm_and_si128(x, m);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(x, 12), m);
+    r = _mm_or_si128(r, _mm_slli_epi32(r, 4));
+    g = _mm_or_si128(g, _mm_slli_epi32(g, 4));
+    b = _mm_or_si128(b, _mm_slli_epi32(b, 4));
+    return _mm_or_si128(_mm_or_si128(_mm_sll_epi32(r, rs), _mm_sll_epi32(g, gs)),
+                        _mm_or_si128(_mm_sll_epi32(b, bs), a));
+}
+
+CONVERT_TARGET("sse2")
+static void color_sse2(const convert_format_t* f, Uint32* dst, const Uint8* src, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rs   = _mm_cvtsi32_si128(f->rShift);
+    const __m128i gs   = _mm_cvtsi32_si128(f->gShift);
+    const __m128i bs   = _mm_cvtsi32_si128(f->bShift);
+    const __m128i a    = _mm_set1_epi32(f->alpha);
+    int i;
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&src[i * 2]);
+        _mm_storeu_si128((__m128i*)&dst[i],     color4_sse2(_mm_unpacklo_epi16(v, zero), rs, gs, bs, a));
+        _mm_storeu_si128((__m128i*)&dst[i + 4], color4_sse2(_mm_unpackhi_epi16(v, zero), rs, gs, bs, a));
+    }
+    color_scalar(f, &dst[i], &src[i * 2], count - i);
+}
+
+CONVERT_TARGET("sse2")
+static void dimension_sse2(const convert_format_t* f, Uint32* dst, const Uint32* src, int count) {
+    const __m128i m  = _mm_set1_epi32(0xFF);
+    const __m128i rs = _mm_cvtsi32_si128(f->rShift);
+    const __m128i gs = _mm_cvtsi32_si128(f->gShift);
+    const __m128i bs = _mm_cvtsi32_si128(f->bShift);
+    const __m128i a  = _mm_set1_epi32(f->alpha);
+    int i;
+    for (i = 0; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(v, ND_R_SHIFT), m);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(v, ND_G_SHIFT), m);
+        __m128i b = _mm_and_si128(v, m);
+        v = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(r, rs), _mm_sll_epi32(g, gs)),
+                         _mm_or_si128(_mm_sll_epi32(b, bs), a));
+        _mm_storeu_si128((__m128i*)&dst[i], v);
+    }
+    dimension_scalar(f, &dst[i], &src[i], count - i);
+}
+
+
+/* **** AVX2 kernels **** */
+
+CONVERT_TARGET("avx2")
+static inline __m256i color8_avx2(__m256i x, __m128i rs, __m128i gs, __m128i bs, __m256i a) {
+    const __m256i m = _mm256_set1_epi32(0xF);
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(x, 4), m);
+    __m256i g = _mm256_and_si256(x, m);
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(x, 12), m);
+    r = _mm256_or_si256(r, _mm256_slli_epi32(r, 4));
+    g = _mm256_or_si256(g, _mm256_slli_epi32(g, 4));
+    b = _mm256_or_si256(b, _mm256_slli_epi32(b, 4));
+    return _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(r, rs), _mm256_sll_epi32(g, gs)),
+                           _mm256_or_si256(_mm256_sll_epi32(b, bs), a));
+}
+
+CONVERT_TARGET("avx2")
+static void color_avx2(const convert_format_t* f, Uint32* dst, const Uint8* src, int count) {
+    const __m128i rs = _mm_cvtsi32_si128(f->rShift);
+    const __m128i gs = _mm_cvtsi32_si128(f->gShift);
+    const __m128i bs = _mm_cvtsi32_si128(f->bShift);
+    const __m256i a  = _mm256_set1_epi32(f->alpha);
+    int i;
+    for (i = 0; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&src[i * 2]));
+        __m256i hi = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&src[i * 2 + 16]));
+        _mm256_storeu_si256((__m256i*)&dst[i],     color8_avx2(lo, rs, gs, bs, a));
+        _mm256_storeu_si256((__m256i*)&dst[i + 8], color8_avx2(hi, rs, gs, bs, a));
+    }
+    color_scalar(f, &dst[i], &src[i * 2], count - i);
+}
+
+CONVERT_TARGET("avx2")
+static void dimension_avx2(const convert_format_t* f, Uint32* dst, const Uint32* src, int count) {
+    const __m256i m  = _mm256_set1_epi32(0xFF);
+    const __m128i rs = _mm_cvtsi32_si128(f->rShift);
+    const __m128i gs = _mm_cvtsi32_si128(f->gShift);
+    const __m128i bs = _mm_cvtsi32_si128(f->bShift);
+    const __m256i a  = _mm256_set1_epi32(f->alpha);
+    int i;
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)&src[i]);
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(v, ND_R_SHIFT), m);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(v, ND_G_SHIFT), m);
+        __m256i b = _mm256_and_si256(v, m);
+        v = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(r, rs), _mm256_sll_epi32(g, gs)),
+                            _mm256_or_si256(_mm256_sll_epi32(b, bs), a));
+        _mm256_storeu_si256((__m256i*)&dst[i], v);
+    }
+    dimension_scalar(f, &dst[i], &src[i], count - i);
+}
+#endif /* CONVERT_X86 */
+
+
+#if CONVERT_NEON
+/* **** NEON kernels **** */
+
+static void bw_neon(Uint32* dst, const Uint8* src, int count) {
+    for (int i = 0; i < count; i++, dst += 4)
+        vst1q_u32(dst, vld1q_u32(&BW2RGB[src[i] * 4]));
+}
+
+static inline uint32x4_t color4_neon(uint32x4_t x, int32x4_t rs, int32x4_t gs, int32x4_t bs, uint32x4_t a) {
+    const uint32x4_t m = vdupq_n_u32(0xF);
+    uint32x4_t r = vandq_u32(vshrq_n_u32(x, 4), m);
+    uint32x4_t g = vandq_u32(x, m);
+    uint32x4_t b = vandq_u32(vshrq_n_u32(x, 12), m);
+    r = vorrq_u32(r, vshlq_n_u32(r, 4));
+    g = vorrq_u32(g, vshlq_n_u32(g, 4));
+    b = vorrq_u32(b, vshlq_n_u32(b, 4));
+    return vorrq_u32(vorrq_u32(vshlq_u32(r, rs), vshlq_u32(g, gs)),
+                     vorrq_u32(vshlq_u32(b, bs), a));
+}
+
+static void color_neon(const convert_format_t* f, Uint32* dst, const Uint8* src, int count) {
+    const int32x4_t  rs = vdupq_n_s32(f->rShift);
+    const int32x4_t  gs = vdupq_n_s32(f->gShift);
+    const int32x4_t  bs = vdupq_n_s32(f->bShift);
+    const uint32x4_t a  = vdupq_n_u32(f->alpha);
+    int i;
+    for (i = 0; i + 8 <= count; i += 8) {
+        uint16x8_t v = vld1q_u16((const uint16_t*)&src[i * 2]);
+        vst1q_u32(&dst[i],     color4_neon(vmovl_u16(vget_low_u16(v)),  rs, gs, bs, a));
+        vst1q_u32(&dst[i + 4], color4_neon(vmovl_u16(vget_high_u16(v)), rs, gs, bs, a));
+    }
+    color_scalar(f, &dst[i], &src[i * 2], count - i);
+}
+
+static void dimension_neon(const convert_format_t* f, Uint32* dst, const Uint32* src, int count) {
+    const uint32x4_t m  = vdupq_n_u32(0xFF);
+    const int32x4_t  rs = vdupq_n_s32(f->rShift);
+    const int32x4_t  gs = vdupq_n_s32(f->gShift);
+    const int32x4_t  bs = vdupq_n_s32(f->bShift);
+    const uint32x4_t a  = vdupq_n_u32(f->alpha);
+    int i;
+    for (i = 0; i + 4 <= count; i += 4) {
+        uint32x4_t v = vld1q_u32(&src[i]);
+        uint32x4_t r = vandq_u32(vshrq_n_u32(v, ND_R_SHIFT), m);
+        uint32x4_t g = vandq_u32(vshrq_n_u32(v, ND_G_SHIFT), m);
+        uint32x4_t b = vandq_u32(v, m);
+        v = vorrq_u32(vorrq_u32(vshlq_u32(r, rs), vshlq_u32(g, gs)),
+                      vorrq_u32(vshlq_u32(b, bs), a));
+        vst1q_u32(&dst[i], v);
+    }
+    dimension_scalar(f, &dst[i], &src[i], count - i);
+}
+#endif /* CONVERT_NEON */
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Use the named set of conversion kernels: "scalar", "SSE2", "AVX2" or
+ * "NEON". Returns false if the host CPU does not support it.
+ */
+bool Convert_UseKernels(const char* name) {
+    if (!strcmp(name, "scalar")) {
+        convertBW        = bw_scalar;
+        convertColor     = color_scalar;
+        convertDimension = dimension_scalar;
+        return true;
+    }
+#if CONVERT_X86
+    if (!strcmp(name, "SSE2") && SDL_HasSSE2()) {
+        convertBW        = bw_sse2;
+        convertColor     = color_sse2;
+        convertDimension = dimension_sse2;
+        return true;
+    }
+#if SDL_VERSION_ATLEAST(2, 0, 4)
+    if (!strcmp(name, "AVX2") && SDL_HasSSE2() && SDL_HasAVX2()) {
+        convertBW        = bw_sse2;
+        convertColor     = color_avx2;
+        convertDimension = dimension_avx2;
+        return true;
+    }
+#endif
+#elif CONVERT_NEON
+    if (!strcmp(name, "NEON")) {
+        convertBW        = bw_neon;
+        convertColor     = color_neon;
+        convertDimension = dimension_neon;
+        return true;
+    }
+#endif
+    return false;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Select the fastest conversion kernels for the host CPU.
+ */
+static void Convert_SelectKernels(void) {
+    static const char* names[] = { "AVX2", "SSE2", "NEON", "scalar" };
+    int i;
+
+    for (i = 0; !Convert_UseKernels(names[i]); i++)
+        ;
+    Log_Printf(LOG_INFO, "Framebuffer conversion: %s\n", names[i]);
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Describe a destination pixel format. Formats with 8 bit channels in a
+ * 32 bit pixel are converted with shifts, all others with SDL_MapRGB.
+ */
+void Convert_SetFormat(convert_format_t* f, Uint32 format) {
+    int    bpp;
+    Uint32 r, g, b, a;
+
+    if (!convertBW)
+        Convert_SelectKernels();
+
+    SDL_PixelFormatEnumToMasks(format, &bpp, &r, &g, &b, &a);
+
+    f->format = format;
+    f->pf     = NULL;
+    f->rgb8   = bpp == 32 && r && g && b &&
+                r / (r & -r) == 0xFF && g / (g & -g) == 0xFF && b / (b & -b) == 0xFF;
+    if (f->rgb8) {
+        f->rShift = SDL_MostSignificantBitIndex32(r & -r);
+        f->gShift = SDL_MostSignificantBitIndex32(g & -g);
+        f->bShift = SDL_MostSignificantBitIndex32(b & -b);
+        f->alpha  = a;
+    } else {
+        f->rShift = f->gShift = f->bShift = 0;
+        f->alpha  = 0;
+        f->pf     = SDL_AllocFormat(format);
+    }
+}
+
+void Convert_FreeFormat(convert_format_t* f) {
+    if (f->pf) {
+        SDL_FreeFormat(f->pf);
+        f->pf = NULL;
+    }
+}
+
+static Uint32 bw2rgb(const convert_format_t* f, int bw) {
+    static const Uint8 gray[4] = { 255, 170, 85, 0 };
+    Uint8 v = gray[bw & 3];
+    if (f->rgb8)
+        return (v << f->rShift) | (v << f->gShift) | (v << f->bShift) | f->alpha;
+    return SDL_MapRGB(f->pf, v, v, v);
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Set up the main framebuffer conversion for the given texture format.
+ */
+void Convert_Init(Uint32 format) {
+    Convert_FreeFormat(&fbFormat);
+    Convert_SetFormat(&fbFormat, format);
+
+    /* initialize BW lookup table */
+    for (int i = 0; i < 0x100; i++) {
+        BW2RGB[i*4+0] = bw2rgb(&fbFormat, i>>6);
+        BW2RGB[i*4+1] = bw2rgb(&fbFormat, i>>4);
+        BW2RGB[i*4+2] = bw2rgb(&fbFormat, i>>2);
+        BW2RGB[i*4+3] = bw2rgb(&fbFormat, i>>0);
+    }
+    /* initialize color lookup table, indexed by the big-endian pixel */
+    if (!fbFormat.rgb8) {
+        for (int i = 0; i < 0x10000; i++) {
+            int r = (i >> 12) & 0xF;
+            int g = (i >> 8)  & 0xF;
+            int b = (i >> 4)  & 0xF;
+            COL2RGB[i] = SDL_MapRGB(fbFormat.pf, r * 0x11, g * 0x11, b * 0x11);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Convert count bytes (4 pixels each) of the BW framebuffer.
+ */
+void Convert_BW(Uint32* dst, const Uint8* src, int count) {
+    convertBW(dst, src, count);
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Convert count pixels of the color framebuffer.
+ */
+void Convert_Color(Uint32* dst, const Uint8* src, int count) {
+    if (fbFormat.rgb8)
+        convertColor(&fbFormat, dst, src, count);
+    else
+        color_table(&fbFormat, dst, src, count);
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Convert count pixels of a NeXTdimension framebuffer.
+ */
+void Convert_Dimension(const convert_format_t* f, Uint32* dst, const Uint32* src, int count) {
+    if (f->rgb8)
+        convertDimension(f, dst, src, count);
+    else
+        dimension_mapRGB(f, dst, src, count);
+}
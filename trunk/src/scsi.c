@@ -8,6 +8,9 @@
 #include "statusbar.h"
 #include "scsi.h"
 #include "file.h"
+#include "diskio.h"
+#include "overlay.h"
+#include "memorySnapShot.h"
 
 #define LOG_SCSI_LEVEL  LOG_DEBUG    /* Print debugging messages */
 
@@ -19,6 +22,9 @@
 
 #define BLOCKSIZE 512
 
+#define SCSI_CHUNK_BLOCKS       (SCSI_BUFFER_SIZE/BLOCKSIZE) /* blocks per disk access */
+#define SCSI_READAHEAD_BLOCKS   256                          /* 128 kB */
+
 #define LUN_DISK 0 // for now only LUN 0 is valid for our phys drives
 
 /* Status Codes */
@@ -65,6 +71,7 @@
 #define SC_NO_ERROR         0x00    // 0
 #define SC_NO_SECTOR        0x01    // 4
 #define SC_WRITE_FAULT      0x03    // 5
+#define SC_WRITE_ERROR      0x0C    // 3
 #define SC_NOT_READY        0x04    // 2
 #define SC_INVALID_CMD      0x20    // 5
 #define SC_INVALID_LBA      0x21    // 5
@@ -94,6 +101,7 @@
 #define CMD_REQ_SENSE       0x03    /* Request sense */
 #define CMD_SHIP            0x1B    /* Ship drive */
 #define CMD_READ_CAPACITY1  0x25    /* Read capacity (class 1) */
+#define CMD_SYNC_CACHE      0x35    /* Synchronize cache (class 1) */
 
 void SCSI_Emulate_Command(Uint8 *cdb);
 
@@ -106,6 +114,7 @@ void SCSI_WriteSector(Uint8 *cdb);
 void SCSI_RequestSense(Uint8 *cdb);
 void SCSI_ModeSense(Uint8 *cdb);
 void SCSI_FormatDrive(Uint8 *cdb);
+void SCSI_SyncCache(Uint8 *cdb);
 
 
 /* Helpers */
@@ -122,6 +131,7 @@ void scsi_write_sector(void);
 struct {
     SCSI_DEVTYPE devtype;
     FILE* dsk;
+    Uint8* map; /* memory mapped image, NULL if not mapped */
     Uint64 size;
     bool readonly;
     Uint8 lun;
@@ -138,8 +148,16 @@ struct {
     Uint32 lba;
     Uint32 blockcounter;
     Uint32 lastlba;
+    Uint32 nextlba; /* block following the last read, for read-ahead */
+    
+    OVERLAY* overlay; /* copy-on-write overlay if write protection is on */
+    
+    /* Read-ahead cache */
+    Uint8* cache;
+    Uint32 cache_lba;
+    Uint32 cache_blocks;
     
-    Uint8** shadow;
+    SCSI_STATS stats;
 } SCSIdisk[ESP_MAX_DEVS];
 
 
@@ -182,12 +200,152 @@ void SCSI_Reset(void) {
     SCSI_Init();
 }
 
+void SCSI_GetStats(Uint8 target, SCSI_STATS *stats) {
+    *stats = SCSIdisk[target].stats;
+}
+
+/* Overlay operations */
+bool SCSI_OverlayCommit(Uint8 target) {
+    FILE* base;
+    bool  ok;
+    
+    if (!SCSIdisk[target].overlay) {
+        return false;
+    }
+    SCSIdisk[target].cache_blocks = 0;
+    if (SCSIdisk[target].overlay->parent) {
+        return Overlay_Commit(SCSIdisk[target].overlay, NULL);
+    }
+    /* The image may be opened read-only, open it for writing only here */
+    ok = DiskIO_Flush(SCSIdisk[target].dsk, false);
+    if (!ok) {
+        Log_Printf(LOG_WARN, "SCSI Disk%i: Writing image file failed\n", target);
+    }
+    base = File_Open(ConfigureParams.SCSI.target[target].szImageName, "rb+");
+    if (base == NULL) {
+        Log_Printf(LOG_WARN, "SCSI Disk%i: Cannot open image file %s for writing\n",
+                   target, ConfigureParams.SCSI.target[target].szImageName);
+        return false;
+    }
+    ok = Overlay_Commit(SCSIdisk[target].overlay, base) && ok;
+    File_Close(base);
+    return ok;
+}
+
+bool SCSI_OverlayDiscard(Uint8 target) {
+    if (!SCSIdisk[target].overlay) {
+        return false;
+    }
+    SCSIdisk[target].cache_blocks = 0;
+    Overlay_Discard(SCSIdisk[target].overlay);
+    return true;
+}
+
+bool SCSI_OverlayPush(Uint8 target, const char *path) {
+    OVERLAY* top;
+    
+    if (!SCSIdisk[target].overlay) {
+        return false;
+    }
+    top = Overlay_Push(SCSIdisk[target].overlay, path);
+    if (!top) {
+        return false;
+    }
+    SCSIdisk[target].overlay = top;
+    strncpy(ConfigureParams.SCSI.target[target].szOverlayName, path, FILENAME_MAX - 1);
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of SCSI variables. Disk images and overlay files
+ * are not stored, only the blocks of temporary overlays.
+ */
+void SCSI_MemorySnapShot_Capture(bool bSave) {
+    int i;
+    Uint32 lba, blocks, count;
+    
+    MemorySnapShot_Store(&SCSIbus, sizeof(SCSIbus));
+    MemorySnapShot_Store(&scsi_buffer.limit, sizeof(scsi_buffer.limit));
+    MemorySnapShot_Store(&scsi_buffer.size, sizeof(scsi_buffer.size));
+    MemorySnapShot_Store(&scsi_buffer.disk, sizeof(scsi_buffer.disk));
+    if (scsi_buffer.limit < 0 || scsi_buffer.limit > SCSI_BUFFER_SIZE) {
+        scsi_buffer.limit = scsi_buffer.size = 0;
+    }
+    MemorySnapShot_Store(scsi_buffer.data, scsi_buffer.limit);
+    
+    for (i = 0; i < ESP_MAX_DEVS; i++) {
+        FILE*    dsk      = SCSIdisk[i].dsk;
+        Uint8*   map      = SCSIdisk[i].map;
+        Uint64   size     = SCSIdisk[i].size;
+        bool     readonly = SCSIdisk[i].readonly;
+        OVERLAY* overlay  = SCSIdisk[i].overlay;
+        Uint8*   cache    = SCSIdisk[i].cache;
+        
+        MemorySnapShot_Store(&SCSIdisk[i], sizeof(SCSIdisk[i]));
+        
+        SCSIdisk[i].dsk      = dsk;
+        SCSIdisk[i].map      = map;
+        SCSIdisk[i].size     = size;
+        SCSIdisk[i].readonly = readonly;
+        SCSIdisk[i].overlay  = overlay;
+        SCSIdisk[i].cache    = cache;
+        if (!bSave) {
+            SCSIdisk[i].cache_blocks = 0;
+        }
+        
+        blocks = SCSIdisk[i].size / BLOCKSIZE;
+        count  = 0;
+        if (bSave && overlay && !overlay->path) {
+            count = overlay->used;
+        }
+        MemorySnapShot_Store(&count, sizeof(count));
+        
+        if (bSave) {
+            Uint8 block[BLOCKSIZE];
+            
+            for (lba = 0; count && lba < blocks; lba++) {
+                if (overlay->index[lba]) {
+                    Overlay_Read(overlay, lba, block);
+                    MemorySnapShot_Store(&lba, sizeof(lba));
+                    MemorySnapShot_Store(block, BLOCKSIZE);
+                }
+            }
+        } else {
+            Uint8 block[BLOCKSIZE];
+            
+            if (overlay && !overlay->path) {
+                Overlay_Discard(overlay);
+            }
+            if (count && !overlay && blocks) {
+                SCSIdisk[i].overlay = overlay = Overlay_Open(NULL, blocks);
+            }
+            while (count--) {
+                MemorySnapShot_Store(&lba, sizeof(lba));
+                MemorySnapShot_Store(block, BLOCKSIZE);
+                if (overlay) {
+                    Overlay_Write(overlay, lba, block);
+                }
+            }
+        }
+    }
+}
+
 void SCSI_Eject(Uint8 i) {
+    File_Unmap(SCSIdisk[i].map);
+    SCSIdisk[i].map = NULL;
+    if (SCSIdisk[i].dsk && !DiskIO_Flush(SCSIdisk[i].dsk, true)) {
+        Log_Printf(LOG_WARN, "SCSI Disk%i: Writing image file failed\n", i);
+    }
     File_Close(SCSIdisk[i].dsk);
     SCSIdisk[i].dsk = NULL;
     SCSIdisk[i].size = 0;
     SCSIdisk[i].readonly = false;
-    SCSIdisk[i].shadow = NULL;
+    Overlay_Close(SCSIdisk[i].overlay);
+    SCSIdisk[i].overlay = NULL;
+    free(SCSIdisk[i].cache);
+    SCSIdisk[i].cache = NULL;
+    SCSIdisk[i].cache_blocks = 0;
 }
 
 static void SCSI_EjectDisk(Uint8 i) {
@@ -198,19 +356,32 @@ static void SCSI_EjectDisk(Uint8 i) {
 }
 
 void SCSI_Insert(Uint8 i) {
+    bool overlay;
+    
     SCSIdisk[i].lun = SCSIdisk[i].status = SCSIdisk[i].message = 0;
     SCSIdisk[i].sense.code = SCSIdisk[i].sense.key = SCSIdisk[i].sense.info = 0;
     SCSIdisk[i].sense.valid = false;
     SCSIdisk[i].lba = SCSIdisk[i].lastlba = SCSIdisk[i].blockcounter = 0;
+    SCSIdisk[i].nextlba = 0;
     
-    SCSIdisk[i].shadow = NULL;
+    SCSIdisk[i].overlay = NULL;
+    SCSIdisk[i].map = NULL;
+    free(SCSIdisk[i].cache);
+    SCSIdisk[i].cache = NULL;
+    SCSIdisk[i].cache_blocks = 0;
+    memset(&SCSIdisk[i].stats, 0, sizeof(SCSIdisk[i].stats));
     
     Log_Printf(LOG_WARN, "SCSI Disk%i: %s\n",i,ConfigureParams.SCSI.target[i].szImageName);
     
     if (File_Exists(ConfigureParams.SCSI.target[i].szImageName) &&
         ConfigureParams.SCSI.target[i].bDiskInserted) {
+        /* With an overlay all writes go to the overlay file, the image
+         * itself is only read and may be read-only on the host */
+        overlay = ConfigureParams.SCSI.target[i].szOverlayName[0] &&
+                  !ConfigureParams.SCSI.target[i].bWriteProtected &&
+                  ConfigureParams.SCSI.target[i].nDeviceType!=DEVTYPE_CD;
         if (ConfigureParams.SCSI.target[i].bWriteProtected ||
-            ConfigureParams.SCSI.target[i].nDeviceType==DEVTYPE_CD) {
+            ConfigureParams.SCSI.target[i].nDeviceType==DEVTYPE_CD || overlay) {
             SCSIdisk[i].dsk = File_Open(ConfigureParams.SCSI.target[i].szImageName, "rb");
             if (SCSIdisk[i].dsk == NULL) {
                 Log_Printf(LOG_WARN, "SCSI Disk%i: Cannot open image file %s\n",
@@ -222,7 +393,7 @@ void SCSI_Insert(Uint8 i) {
                 }
             } else {
                 SCSIdisk[i].size = File_Length(ConfigureParams.SCSI.target[i].szImageName);
-                SCSIdisk[i].readonly = true;
+                SCSIdisk[i].readonly = !overlay;
             }
         } else {
             SCSIdisk[i].dsk = File_Open(ConfigureParams.SCSI.target[i].szImageName, "rb+");
@@ -246,6 +417,17 @@ void SCSI_Insert(Uint8 i) {
                 SCSIdisk[i].readonly = false;
             }
         }
+        if (SCSIdisk[i].dsk && ConfigureParams.System.bMapDiskImages) {
+            SCSIdisk[i].map = File_Map(SCSIdisk[i].dsk, !SCSIdisk[i].readonly && !overlay);
+        }
+        if (SCSIdisk[i].dsk && overlay) {
+            Log_Printf(LOG_WARN, "SCSI Disk%i: Overlay %s\n", i, ConfigureParams.SCSI.target[i].szOverlayName);
+            SCSIdisk[i].overlay = Overlay_Open(ConfigureParams.SCSI.target[i].szOverlayName, SCSIdisk[i].size/BLOCKSIZE);
+            if (!SCSIdisk[i].overlay) {
+                SCSIdisk[i].readonly = true;
+                Log_Printf(LOG_WARN, "SCSI Disk%i: Cannot open overlay. Enabling write protection.\n", i);
+            }
+        }
     } else {
         SCSIdisk[i].size = 0;
         SCSIdisk[i].dsk = NULL;
@@ -329,6 +511,8 @@ void SCSI_Emulate_Command(Uint8 *cdb) {
     Uint8 opcode = cdb[0];
     Uint8 target = SCSIbus.target;
     
+    SCSIdisk[target].stats.commands++;
+    
     /* First check for lun-independent commands */
     switch (opcode) {
         case CMD_INQUIRY:
@@ -391,6 +575,10 @@ void SCSI_Emulate_Command(Uint8 *cdb) {
                     Log_Printf(LOG_SCSI_LEVEL, "SCSI command: Format drive\n");
                     SCSI_FormatDrive(cdb);
                     break;
+                case CMD_SYNC_CACHE:
+                    Log_Printf(LOG_SCSI_LEVEL, "SCSI command: Synchronize cache\n");
+                    SCSI_SyncCache(cdb);
+                    break;
                     /* as of yet unsupported commands */
                 case CMD_VERIFY_TRACK:
                 case CMD_FORMAT_TRACK:
@@ -490,9 +678,18 @@ static void SCSI_GuessGeometry(Uint32 size, Uint32 *cylinders, Uint32 *heads, Ui
 #define SCSI_SEEK_TIME_CD       500000 /* 500 ms max seek time */
 #define SCSI_SECTOR_TIME_CD     3250   /* 150 kB/sec */
 
+static Uint32 scsi_buffered_blocks(void) {
+    /* Blocks read ahead of the transfer by the last disk access */
+    if (scsi_buffer.disk && SCSIbus.phase==PHASE_DI) {
+        return scsi_buffer.size/BLOCKSIZE;
+    }
+    return 0;
+}
+
 Sint64 SCSI_Seek_Time(void) {
     Uint8 target = SCSIbus.target;
     Sint64 seektime, seekoffset, disksize;
+    Uint32 lba = SCSIdisk[target].lba - scsi_buffered_blocks();
     
     if (scsi_buffer.disk) {
         switch (SCSIdisk[target].devtype) {
@@ -508,10 +705,10 @@ Sint64 SCSI_Seek_Time(void) {
             default:
                 return 0;
         }
-        if (SCSIdisk[target].lba < SCSIdisk[target].lastlba) {
-            seekoffset = SCSIdisk[target].lastlba - SCSIdisk[target].lba;
+        if (lba < SCSIdisk[target].lastlba) {
+            seekoffset = SCSIdisk[target].lastlba - lba;
         } else {
-            seekoffset = SCSIdisk[target].lba - SCSIdisk[target].lastlba;
+            seekoffset = lba - SCSIdisk[target].lastlba;
         }
         disksize = SCSIdisk[target].size/BLOCKSIZE;
         
@@ -533,7 +730,7 @@ Sint64 SCSI_Seek_Time(void) {
 
 Sint64 SCSI_Sector_Time(void) {
     int target = SCSIbus.target;
-    Sint64 sectors = SCSIdisk[target].blockcounter;
+    Sint64 sectors = SCSIdisk[target].blockcounter + scsi_buffered_blocks();
     
     if (sectors <= 0) {
         sectors = 1;
@@ -688,6 +885,112 @@ void SCSI_ReadCapacity(Uint8 *cdb) {
     SCSIdisk[target].sense.valid = false;
 }
 
+/* Disk access helpers */
+static Uint32 scsi_chunk_blocks(Uint8 target) {
+    /* Number of blocks for the next transfer chunk */
+    if (SCSIdisk[target].blockcounter==0) {
+        return 1;
+    }
+    if (SCSIdisk[target].blockcounter<SCSI_CHUNK_BLOCKS) {
+        return SCSIdisk[target].blockcounter;
+    }
+    return SCSI_CHUNK_BLOCKS;
+}
+
+static Uint32 scsi_valid_blocks(Uint8 target, Uint32 lba, Uint32 count) {
+    /* Number of blocks from lba that are inside the disk image */
+    Uint32 blocks = SCSIdisk[target].size / BLOCKSIZE;
+    
+    if (lba >= blocks) {
+        return 0;
+    }
+    if (count > blocks - lba) {
+        return blocks - lba;
+    }
+    return count;
+}
+
+static void scsi_read_blocks(Uint8 target, Uint32 lba, Uint32 count, Uint8 *buf) {
+    /* Read blocks from the mapped image, the read-ahead cache or the disk
+     * image. Sequential reads fill the cache with up to SCSI_READAHEAD_BLOCKS
+     * blocks, mapped images need no cache. */
+    Uint32 i, n;
+    bool cached = false;
+    
+    if (SCSIdisk[target].map) {
+        File_MapRead(SCSIdisk[target].map, buf, count * BLOCKSIZE, ((Uint64)lba) * BLOCKSIZE, SCSIdisk[target].dsk);
+    } else if (SCSIdisk[target].cache_blocks && lba >= SCSIdisk[target].cache_lba &&
+        lba + count <= SCSIdisk[target].cache_lba + SCSIdisk[target].cache_blocks) {
+        memcpy(buf, SCSIdisk[target].cache + (lba - SCSIdisk[target].cache_lba) * BLOCKSIZE, count * BLOCKSIZE);
+        SCSIdisk[target].stats.cache_hits++;
+    } else if (lba == SCSIdisk[target].nextlba && count < SCSI_READAHEAD_BLOCKS) {
+        n = scsi_valid_blocks(target, lba, SCSI_READAHEAD_BLOCKS);
+        if (!SCSIdisk[target].cache) {
+            SCSIdisk[target].cache = malloc(SCSI_READAHEAD_BLOCKS * BLOCKSIZE);
+        }
+        SCSIdisk[target].cache_blocks = 0;
+        if (SCSIdisk[target].cache) {
+            SCSIdisk[target].stats.syscalls++;
+            cached = DiskIO_Read(NULL, SCSIdisk[target].cache, n * BLOCKSIZE, ((Uint64)lba) * BLOCKSIZE, SCSIdisk[target].dsk);
+        }
+        if (cached) {
+            SCSIdisk[target].cache_lba = lba;
+            SCSIdisk[target].cache_blocks = n;
+            memcpy(buf, SCSIdisk[target].cache, count * BLOCKSIZE);
+        } else {
+            SCSIdisk[target].stats.syscalls++;
+            DiskIO_Read(NULL, buf, count * BLOCKSIZE, ((Uint64)lba) * BLOCKSIZE, SCSIdisk[target].dsk);
+        }
+    } else {
+        SCSIdisk[target].stats.syscalls++;
+        DiskIO_Read(NULL, buf, count * BLOCKSIZE, ((Uint64)lba) * BLOCKSIZE, SCSIdisk[target].dsk);
+    }
+    SCSIdisk[target].nextlba = lba + count;
+    
+    if (SCSIdisk[target].overlay) {
+        for (i = 0; i < count; i++) {
+            Overlay_Read(SCSIdisk[target].overlay, lba + i, buf + i * BLOCKSIZE);
+        }
+    }
+}
+
+static void scsi_write_blocks(Uint8 target, Uint32 lba, Uint32 count, Uint8 *buf) {
+    /* Write blocks to the disk image, or to the overlay if there is one
+     * or file write is disabled. Cached blocks are updated. */
+    Uint32 i, first, last;
+    
+    if (!SCSIdisk[target].overlay && ConfigureParams.SCSI.nWriteProtection != WRITEPROT_ON) {
+        if (SCSIdisk[target].map) {
+            File_MapWrite(SCSIdisk[target].map, buf, count * BLOCKSIZE, ((Uint64)lba) * BLOCKSIZE, SCSIdisk[target].dsk);
+        } else {
+            SCSIdisk[target].stats.syscalls++;
+            DiskIO_Write(NULL, buf, count * BLOCKSIZE, ((Uint64)lba) * BLOCKSIZE, SCSIdisk[target].dsk);
+        }
+    } else {
+        Log_Printf(LOG_SCSI_LEVEL, "[SCSI] WARNING: File write disabled!");
+        if (!SCSIdisk[target].overlay) {
+            SCSIdisk[target].overlay = Overlay_Open(NULL, SCSIdisk[target].size / BLOCKSIZE);
+        }
+        if (SCSIdisk[target].overlay) {
+            for (i = 0; i < count; i++) {
+                Overlay_Write(SCSIdisk[target].overlay, lba + i, buf + i * BLOCKSIZE);
+            }
+        }
+    }
+    
+    if (SCSIdisk[target].cache_blocks) {
+        first = lba > SCSIdisk[target].cache_lba ? lba : SCSIdisk[target].cache_lba;
+        last  = lba + count;
+        if (last > SCSIdisk[target].cache_lba + SCSIdisk[target].cache_blocks) {
+            last = SCSIdisk[target].cache_lba + SCSIdisk[target].cache_blocks;
+        }
+        if (first < last) {
+            memcpy(SCSIdisk[target].cache + (first - SCSIdisk[target].cache_lba) * BLOCKSIZE,
+                   buf + (first - lba) * BLOCKSIZE, (last - first) * BLOCKSIZE);
+        }
+    }
+}
+
 void SCSI_WriteSector(Uint8 *cdb) {
     Uint8 target = SCSIbus.target;
     
@@ -705,45 +1008,36 @@ void SCSI_WriteSector(Uint8 *cdb) {
     }
     scsi_buffer.disk=true;
     scsi_buffer.size=0;
-    scsi_buffer.limit=BLOCKSIZE;
+    scsi_buffer.limit=scsi_chunk_blocks(target)*BLOCKSIZE;
     SCSIbus.phase = PHASE_DO;
     Log_Printf(LOG_SCSI_LEVEL, "[SCSI] Write sector: %i block(s) at offset %i (blocksize: %i byte)",
                SCSIdisk[target].blockcounter, SCSIdisk[target].lba, BLOCKSIZE);
 }
 
 void scsi_write_sector(void) {
+    /* Write the buffered chunk. Blocks up to the end of the disk image
+     * are written before an invalid block is reported. */
     Uint8 target = SCSIbus.target;
-    Uint64 offset = 0;
+    Uint32 count = scsi_buffer.limit/BLOCKSIZE;
+    Uint32 valid = scsi_valid_blocks(target, SCSIdisk[target].lba, count);
 
-    Log_Printf(LOG_SCSI_LEVEL, "[SCSI] Writing block at offset %i (%i blocks remaining).",
-               SCSIdisk[target].lba,SCSIdisk[target].blockcounter-1);
+    Log_Printf(LOG_SCSI_LEVEL, "[SCSI] Writing %i block(s) at offset %i (%i blocks remaining).",
+               count, SCSIdisk[target].lba, SCSIdisk[target].blockcounter-count);
     
-    offset = ((Uint64)SCSIdisk[target].lba)*BLOCKSIZE;
+    if (valid > 0) {
+        scsi_write_blocks(target, SCSIdisk[target].lba, valid, scsi_buffer.data);
+        SCSIdisk[target].stats.bytes += valid*BLOCKSIZE;
+        SCSIdisk[target].lba += valid;
+        SCSIdisk[target].blockcounter -= valid;
+    }
     
-    if (offset < SCSIdisk[target].size) {
-        if (ConfigureParams.SCSI.nWriteProtection != WRITEPROT_ON) {
-            File_Write(scsi_buffer.data, BLOCKSIZE, offset, SCSIdisk[target].dsk);
-        } else {
-            Log_Printf(LOG_SCSI_LEVEL, "[SCSI] WARNING: File write disabled!");
-            if(SCSIdisk[target].shadow) {
-                if(!(SCSIdisk[target].shadow[SCSIdisk[target].lba]))
-                    SCSIdisk[target].shadow[SCSIdisk[target].lba] = malloc(BLOCKSIZE);
-                memcpy(SCSIdisk[target].shadow[SCSIdisk[target].lba], scsi_buffer.data, BLOCKSIZE);
-            } else {
-                Uint32 blocks = SCSIdisk[target].size / BLOCKSIZE;
-                SCSIdisk[target].shadow = malloc(sizeof(Uint8*) * blocks);
-                for(int i = blocks; --i >= 0;)
-                    SCSIdisk[target].shadow[i] = NULL;
-            }
-        }
-        scsi_buffer.limit=BLOCKSIZE;
+    if (valid == count) {
+        scsi_buffer.limit=scsi_chunk_blocks(target)*BLOCKSIZE;
         scsi_buffer.size=0;
 
         SCSIdisk[target].status = STAT_GOOD;
         SCSIdisk[target].sense.code = SC_NO_ERROR;
         SCSIdisk[target].sense.valid = false;
-        SCSIdisk[target].lba++;
-        SCSIdisk[target].blockcounter--;
         if (SCSIdisk[target].blockcounter==0) {
             SCSIbus.phase = PHASE_ST;
         }
@@ -786,32 +1080,31 @@ void SCSI_ReadSector(Uint8 *cdb) {
 }
 
 void scsi_read_sector(void) {
+    /* Read the next chunk of blocks into the buffer */
     Uint8 target = SCSIbus.target;
-    Uint64 offset = 0;
+    Uint32 count, valid;
     
     if (SCSIdisk[target].blockcounter==0) {
         SCSIbus.phase = PHASE_ST;
         return;
     }
     
-    Log_Printf(LOG_SCSI_LEVEL, "[SCSI] Reading block at offset %i (%i blocks remaining).",
-               SCSIdisk[target].lba,SCSIdisk[target].blockcounter-1);
+    count = scsi_chunk_blocks(target);
+    valid = scsi_valid_blocks(target, SCSIdisk[target].lba, count);
     
-    offset = ((Uint64)SCSIdisk[target].lba)*BLOCKSIZE;
+    Log_Printf(LOG_SCSI_LEVEL, "[SCSI] Reading %i block(s) at offset %i (%i blocks remaining).",
+               valid, SCSIdisk[target].lba, SCSIdisk[target].blockcounter-valid);
     
-    if (offset < SCSIdisk[target].size) {
-        if (SCSIdisk[target].shadow && SCSIdisk[target].shadow[SCSIdisk[target].lba]) {
-            memcpy(scsi_buffer.data, SCSIdisk[target].shadow[SCSIdisk[target].lba], BLOCKSIZE);
-        } else {
-            File_Read(scsi_buffer.data, BLOCKSIZE, offset, SCSIdisk[target].dsk);
-        }
-        scsi_buffer.limit=scsi_buffer.size=BLOCKSIZE;
+    if (valid > 0) {
+        scsi_read_blocks(target, SCSIdisk[target].lba, valid, scsi_buffer.data);
+        scsi_buffer.limit=scsi_buffer.size=valid*BLOCKSIZE;
+        SCSIdisk[target].stats.bytes += valid*BLOCKSIZE;
 
         SCSIdisk[target].status = STAT_GOOD;
         SCSIdisk[target].sense.code = SC_NO_ERROR;
         SCSIdisk[target].sense.valid = false;
-        SCSIdisk[target].lba++;
-        SCSIdisk[target].blockcounter--;
+        SCSIdisk[target].lba += valid;
+        SCSIdisk[target].blockcounter -= valid;
     } else {
         SCSIdisk[target].status = STAT_CHECK_COND;
         SCSIdisk[target].sense.code = SC_INVALID_LBA;
@@ -835,6 +1128,27 @@ Uint8 SCSIdisk_Send_Data(void) {
     return val;
 }
 
+int SCSIdisk_Send_Block(Uint8 *dst, int len) {
+    /* Send up to len bytes, but not more than what is left in the
+     * buffer. Returns the number of bytes sent. */
+    if (SCSIbus.phase!=PHASE_DI || scsi_buffer.size<=0) {
+        return 0;
+    }
+    if (len>scsi_buffer.size) {
+        len=scsi_buffer.size;
+    }
+    memcpy(dst, &scsi_buffer.data[scsi_buffer.limit-scsi_buffer.size], len);
+    scsi_buffer.size-=len;
+    if (scsi_buffer.size==0) {
+        if (scsi_buffer.disk==true) {
+            scsi_read_sector(); /* sets status phase if done or error */
+        } else {
+            SCSIbus.phase = PHASE_ST;
+        }
+    }
+    return len;
+}
+
 
 void SCSI_Inquiry (Uint8 *cdb) {
     Uint8 target = SCSIbus.target;
@@ -976,6 +1290,9 @@ void SCSI_RequestSense(Uint8 *cdb) {
         case SC_WRITE_PROTECT:
             SCSIdisk[target].sense.key = SK_DATAPROTECT;
             break;
+        case SC_WRITE_ERROR:
+            SCSIdisk[target].sense.key = SK_MEDIA;
+            break;
         case SC_NO_SECTOR:
         default:
             SCSIdisk[target].sense.key = SK_HARDWARE;
@@ -1131,3 +1448,26 @@ void SCSI_FormatDrive(Uint8 *cdb) {
         SCSIbus.phase = PHASE_ST;
     }
 }
+
+
+/* Write all queued data of the disk image to the host storage */
+void SCSI_SyncCache(Uint8 *cdb) {
+    Uint8 target = SCSIbus.target;
+    bool ok = true;
+    
+    if (SCSIdisk[target].map) {
+        File_SyncMaps(true);
+    } else if (SCSIdisk[target].dsk) {
+        ok = DiskIO_Flush(SCSIdisk[target].dsk, true);
+    }
+    if (ok) {
+        SCSIdisk[target].status = STAT_GOOD;
+        SCSIdisk[target].sense.code = SC_NO_ERROR;
+    } else {
+        Log_Printf(LOG_WARN, "[SCSI] Synchronize cache: Writing disk image failed! Check condition.");
+        SCSIdisk[target].status = STAT_CHECK_COND;
+        SCSIdisk[target].sense.code = SC_WRITE_ERROR;
+    }
+    SCSIdisk[target].sense.valid = false;
+    SCSIbus.phase = PHASE_ST;
+}
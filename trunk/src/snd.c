@@ -7,6 +7,7 @@
 #include "dma.h"
 #include "snd.h"
 #include "kms.h"
+#include "memorySnapShot.h"
 
 #define LOG_SND_LEVEL   LOG_DEBUG
 #define LOG_VOL_LEVEL   LOG_DEBUG
@@ -440,3 +441,13 @@ void snd_gpo_access(Uint8 data) {
     }
     old_data = data;
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of sound variables ('MemorySnapShot_Store' handles type)
+ */
+void Sound_MemorySnapShot_Capture(bool bSave)
+{
+    MemorySnapShot_Store(&sndout_state, sizeof(sndout_state));
+}
@@ -75,6 +75,9 @@ static bool bOldDspLed;
 static SDL_Rect NdLedRect;
 static int nOldNdLed;
 
+/* led colors currently on screen, only changes are redrawn */
+static Uint32 SystemLedColor, DspLedColor, NdLedColor;
+
 /* led colors */
 static Uint32 LedColorOn, LedColorOnWP, LedColorOff, SysColorOn, SysColorOff, DspColorOn, DspColorOff;
 static Uint32 NdColorOn, NdColorCS8, NdColorOff;
@@ -303,6 +306,7 @@ void Statusbar_Init(SDL_Surface *surf)
     SDLGui_Text(ledbox.x - 3*fontw - fontw/2, MessageRect.y, "ND:");
     SDL_FillRect(surf, &ledbox, LedColorBg);
     SDL_FillRect(surf, &NdLedRect, NdColorOff);
+    NdLedColor = NdColorOff;
     nOldNdLed = 0;
 
 	/* draw dsp led box */
@@ -312,6 +316,7 @@ void Statusbar_Init(SDL_Surface *surf)
 	SDLGui_Text(ledbox.x - 4*fontw - fontw/2, MessageRect.y, "DSP:");
 	SDL_FillRect(surf, &ledbox, LedColorBg);
 	SDL_FillRect(surf, &DspLedRect, DspColorOff);
+	DspLedColor = DspColorOff;
 	bOldDspLed = false;
 
 	/* draw system led box */
@@ -321,6 +326,7 @@ void Statusbar_Init(SDL_Surface *surf)
 	SDLGui_Text(ledbox.x - 4*fontw - fontw/2, MessageRect.y, "LED:");
 	SDL_FillRect(surf, &ledbox, LedColorBg);
 	SDL_FillRect(surf, &SystemLedRect, SysColorOff);
+	SystemLedColor = SysColorOff;
 	bOldSystemLed = false;
 
 	/* and blit statusbar on screen */
@@ -660,8 +666,11 @@ void Statusbar_Update(SDL_Surface *surf) {
 	} else {
 		color = DspColorOff;
 	}
-	SDL_FillRect(surf, &DspLedRect, color);
-	SDL_UpdateRects(surf, 1, &DspLedRect);
+	if (color != DspLedColor) {
+		DspLedColor = color;
+		SDL_FillRect(surf, &DspLedRect, color);
+		SDL_UpdateRects(surf, 1, &DspLedRect);
+	}
 
     /* Draw scr2 LED */
     if (bOldSystemLed) {
@@ -669,8 +678,11 @@ void Statusbar_Update(SDL_Surface *surf) {
     } else {
         color = SysColorOff;
     }
-    SDL_FillRect(surf, &SystemLedRect, color);
-    SDL_UpdateRects(surf, 1, &SystemLedRect);
+    if (color != SystemLedColor) {
+        SystemLedColor = color;
+        SDL_FillRect(surf, &SystemLedRect, color);
+        SDL_UpdateRects(surf, 1, &SystemLedRect);
+    }
     
     /* Draw NeXTdimension LED */
     switch(nOldNdLed) {
@@ -679,6 +691,9 @@ void Statusbar_Update(SDL_Surface *surf) {
         case 2:  color = NdColorOn;  break;
 		default: color = NdColorOff; break;
     }
-    SDL_FillRect(surf, &NdLedRect, color);
-    SDL_UpdateRects(surf, 1, &NdLedRect);
+    if (color != NdLedColor) {
+        NdLedColor = color;
+        SDL_FillRect(surf, &NdLedRect, color);
+        SDL_UpdateRects(surf, 1, &NdLedRect);
+    }
 }
@@ -13,6 +13,7 @@
 #include "rtcnvram.h"
 #include "statusbar.h"
 #include "host.h"
+#include "memorySnapShot.h"
 
 #define LOG_HARDCLOCK_LEVEL LOG_DEBUG
 #define LOG_SOFTINT_LEVEL   LOG_DEBUG
@@ -31,6 +32,13 @@ static Uint8 scr2_3=0x00;
 
  Uint32 scrIntStat=0x00000000;
  Uint32 scrIntMask=0x00000000;
+ int    scrIntLevel=0;
+
+/* Re-evaluate the cached interrupt level. Must be called whenever
+ * scrIntStat, scrIntMask or the timer IPL7 bit in SCR2 change. */
+static inline void scr_update_interrupt_level(void) {
+    scrIntLevel = scr_get_interrupt_level(scrIntStat&scrIntMask);
+}
 
 
 
@@ -103,6 +111,7 @@ void SCR_Reset(void) {
 	
     scrIntStat=0x00000000;
     scrIntMask=0x00000000;
+    scrIntLevel=0;
 
     if (ConfigureParams.System.bTurbo) {
         scr1 = SCR1_TURBO;
@@ -296,6 +305,7 @@ void SCR2_Write2(void)
 	if ((old_scr2_2&SCR2_TIMERIPL7)!=(scr2_2&SCR2_TIMERIPL7)) {
 		Log_Printf(LOG_WARN,"SCR2 TIMER IPL7 change at $%08x val=%x PC=$%08x\n",
                            IoAccessCurrentAddress,scr2_2&SCR2_TIMERIPL7,m68k_getpc());
+		scr_update_interrupt_level();
 	}
 
     /* RTC enabled */
@@ -363,6 +373,7 @@ void IntRegStatRead(void) {
 
 void IntRegStatWrite(void) {
     scrIntStat = IoMem_ReadLong(IoAccessCurrentAddress & IO_SEG_MASK);
+    scr_update_interrupt_level();
 }
 
 void set_dsp_interrupt(Uint8 state) {
@@ -375,13 +386,14 @@ void set_dsp_interrupt(Uint8 state) {
 
 void set_interrupt(Uint32 intr, Uint8 state) {
     /* The interrupt gets polled by the cpu via intlev()
-     * --> see previous-glue.c
+     * --> see newcpu.c
      */
     if (state==SET_INT) {
         scrIntStat |= intr;
     } else {
         scrIntStat &= ~intr;
     }
+    scr_update_interrupt_level();
 }
 
 int scr_get_interrupt_level(Uint32 interrupt) {
@@ -416,6 +428,7 @@ void IntRegMaskRead(void) {
 
 void IntRegMaskWrite(void) {
 	scrIntMask = IoMem_ReadLong(IoAccessCurrentAddress & IO_SEG_MASK);
+	scr_update_interrupt_level();
         Log_Printf(LOG_DEBUG,"Interrupt mask: %08x", intMask);
 }
 
@@ -530,3 +543,31 @@ void color_video_interrupt(void) {
 		col_vid_intr &= ~VID_CMD_ENABLE_INT;
 	}
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of system control register variables ('MemorySnapShot_Store' handles type)
+ */
+void SCR_MemorySnapShot_Capture(bool bSave)
+{
+	MemorySnapShot_Store(&SCR_ROM_overlay, sizeof(SCR_ROM_overlay));
+	MemorySnapShot_Store(&scr1, sizeof(scr1));
+	MemorySnapShot_Store(&scr2_0, sizeof(scr2_0));
+	MemorySnapShot_Store(&scr2_1, sizeof(scr2_1));
+	MemorySnapShot_Store(&scr2_2, sizeof(scr2_2));
+	MemorySnapShot_Store(&scr2_3, sizeof(scr2_3));
+	MemorySnapShot_Store(&scrIntStat, sizeof(scrIntStat));
+	MemorySnapShot_Store(&scrIntMask, sizeof(scrIntMask));
+	MemorySnapShot_Store(&hardclock_csr, sizeof(hardclock_csr));
+	MemorySnapShot_Store(&hardclock1, sizeof(hardclock1));
+	MemorySnapShot_Store(&hardclock0, sizeof(hardclock0));
+	MemorySnapShot_Store(&latch_hardclock, sizeof(latch_hardclock));
+	MemorySnapShot_Store(&hardClockLastLatch, sizeof(hardClockLastLatch));
+	MemorySnapShot_Store(&sysTimerOffset, sizeof(sysTimerOffset));
+	MemorySnapShot_Store(&resetTimer, sizeof(resetTimer));
+	MemorySnapShot_Store(&col_vid_intr, sizeof(col_vid_intr));
+
+	if (!bSave)
+		scr_update_interrupt_level();
+}
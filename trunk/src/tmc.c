@@ -5,6 +5,7 @@
 #include "sysReg.h"
 #include "adb.h"
 #include "tmc.h"
+#include "memorySnapShot.h"
 
 #define LOG_TMC_LEVEL LOG_DEBUG
 
@@ -477,3 +478,13 @@ void TMC_Reset(void) {
 	tmc.nitro = 0x00000000;
 	ADB_Reset();
 }
+
+
+/*-----------------------------------------------------------------------*/
+/**
+ * Save/Restore snapshot of TMC variables ('MemorySnapShot_Store' handles type)
+ */
+void TMC_MemorySnapShot_Capture(bool bSave)
+{
+	MemorySnapShot_Store(&tmc, sizeof(tmc));
+}